@@ -0,0 +1,57 @@
+/* 
+ * @copyright (c) 2026
+ * @author agent <agent@local>
+ * @version 1.0
+ */
+
+#include <stdlib.h>
+#include "arena.h"
+
+#define ARENA_ALIGN 16
+
+struct ArenaBlock_ {
+  struct ArenaBlock_ *next;
+  _Alignas(ARENA_ALIGN) char data[];
+};
+
+typedef struct ArenaBlock_ ArenaBlock;
+
+void initArena(Arena* arena) {
+  arena->blocks = NULL;
+  arena->next = NULL;
+  arena->limit = NULL;
+  arena->blockSize = ARENA_FIRST_BLOCK_SIZE;
+}
+
+void* arenaAlloc(Arena* arena, size_t size) {
+  void* p;
+
+  size = (size + ARENA_ALIGN - 1) & ~(size_t) (ARENA_ALIGN - 1);
+  if ((arena->next == NULL) || ((size_t) (arena->limit - arena->next) < size)) {
+    // Oversized requests get a block of their own
+    size_t blockSize = (size > arena->blockSize) ? size : arena->blockSize;
+    ArenaBlock* block = (ArenaBlock*) malloc(sizeof(ArenaBlock) + blockSize);
+
+    if (arena->blockSize < ARENA_BLOCK_SIZE)
+      arena->blockSize *= 2;
+    block->next = arena->blocks;
+    arena->blocks = block;
+    arena->next = block->data;
+    arena->limit = block->data + blockSize;
+  }
+
+  p = arena->next;
+  arena->next += size;
+  return p;
+}
+
+void freeArena(Arena* arena) {
+  ArenaBlock* block = arena->blocks;
+
+  while (block != NULL) {
+    ArenaBlock* next = block->next;
+    free(block);
+    block = next;
+  }
+  initArena(arena);
+}
@@ -0,0 +1,35 @@
+/* 
+ * @copyright (c) 2026
+ * @author agent <agent@local>
+ * @version 1.0
+ */
+
+#ifndef __ARENA_H__
+#define __ARENA_H__
+
+#include <stddef.h>
+
+// Bump allocator: allocations are carved out of blocks and are all
+// released together by freeArena(). The first block is small, so that the
+// many arenas of a parallel compilation cost little; each further one is
+// twice the size of the previous, up to ARENA_BLOCK_SIZE.
+
+#define ARENA_FIRST_BLOCK_SIZE 512
+#define ARENA_BLOCK_SIZE (64 * 1024)
+
+struct ArenaBlock_;
+
+struct Arena_ {
+  struct ArenaBlock_ *blocks;
+  char *next;
+  char *limit;
+  size_t blockSize;             // size of the next block
+};
+
+typedef struct Arena_ Arena;
+
+void initArena(Arena* arena);
+void* arenaAlloc(Arena* arena, size_t size);
+void freeArena(Arena* arena);
+
+#endif
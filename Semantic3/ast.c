@@ -0,0 +1,121 @@
+/* 
+ * @copyright (c) 2026
+ * @author agent <agent@local>
+ * @version 1.0
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "arena.h"
+#include "ast.h"
+
+// Every node and list cell of one compilation lives in this arena, apart
+// from the bodies the pool parses: those go to their task's arena
+_Thread_local Arena astArena;
+_Thread_local Arena* nodeArena = NULL;
+
+// The nodes walkTree() has still to visit
+_Thread_local Node** walkStack = NULL;
+_Thread_local int walkTop = 0;
+_Thread_local int walkSize = 0;
+
+void initAST(void) {
+  initArena(&astArena);
+  nodeArena = &astArena;
+}
+
+void freeAST(void) {
+  freeArena(&astArena);
+  free(walkStack);
+  walkStack = NULL;
+  walkTop = walkSize = 0;
+}
+
+Node* makeNode(enum NodeKind kind, int lineNo, int colNo) {
+  Node* node = (Node*) arenaAlloc(nodeArena, sizeof(Node));
+  memset(node, 0, sizeof(Node));
+  node->kind = kind;
+  node->lineNo = lineNo;
+  node->colNo = colNo;
+  return node;
+}
+
+// Append node at *tail and return the new tail, so lists are built in
+// source order without walking them
+NodeList** appendNode(NodeList** tail, Node* node) {
+  NodeList* cell = (NodeList*) arenaAlloc(nodeArena, sizeof(NodeList));
+  cell->node = node;
+  cell->next = NULL;
+  *tail = cell;
+  return &(cell->next);
+}
+
+/******************* Traversal ******************************/
+
+void pushWalk(Node* node) {
+  if (node == NULL) return;
+  if (walkTop == walkSize) {
+    walkSize = (walkSize == 0) ? 256 : 2 * walkSize;
+    walkStack = (Node**) realloc(walkStack, walkSize * sizeof(Node*));
+  }
+  walkStack[walkTop++] = node;
+}
+
+void pushWalkList(NodeList* list) {
+  for (; list != NULL; list = list->next)
+    pushWalk(list->node);
+}
+
+// Call visit on every node of the tree rooted at root, in no particular
+// order. An explicit stack keeps deep trees off the C stack.
+void walkTree(Node* root, void (*visit)(Node* node)) {
+  Node* node;
+  int base = walkTop;
+
+  pushWalk(root);
+  while (walkTop > base) {
+    node = walkStack[--walkTop];
+    visit(node);
+    switch (node->kind) {
+    case N_CONSTANT:
+    case N_VARIABLE:
+      pushWalkList(node->var.indexes);
+      break;
+    case N_FUNCTION_CALL:
+    case N_CALL:
+      pushWalkList(node->call.args);
+      break;
+    case N_UNARY:
+      pushWalk(node->unary.operand);
+      break;
+    case N_BINARY:
+    case N_CONDITION:
+      pushWalk(node->binary.left);
+      pushWalk(node->binary.right);
+      break;
+    case N_ASSIGN:
+      pushWalk(node->assign.lvalue);
+      pushWalk(node->assign.expr);
+      break;
+    case N_GROUP:
+      pushWalkList(node->group.stmts);
+      break;
+    case N_IF:
+      pushWalk(node->ifSt.cond);
+      pushWalk(node->ifSt.thenSt);
+      pushWalk(node->ifSt.elseSt);
+      break;
+    case N_WHILE:
+      pushWalk(node->whileSt.cond);
+      pushWalk(node->whileSt.body);
+      break;
+    case N_FOR:
+      pushWalk(node->forSt.from);
+      pushWalk(node->forSt.to);
+      pushWalk(node->forSt.body);
+      break;
+    default:
+      break;
+    }
+  }
+}
@@ -0,0 +1,84 @@
+/* 
+ * @copyright (c) 2026
+ * @author agent <agent@local>
+ * @version 1.0
+ */
+
+#ifndef __AST_H__
+#define __AST_H__
+
+#include "token.h"
+#include "symtab.h"
+
+enum NodeKind {
+  // expressions
+  N_NUMBER,
+  N_CHAR,
+  N_CONSTANT,
+  N_VARIABLE,
+  N_FUNCTION_CALL,
+  N_UNARY,
+  N_BINARY,
+  N_CONDITION,
+  // statements
+  N_EMPTY,
+  N_ASSIGN,
+  N_CALL,
+  N_GROUP,
+  N_IF,
+  N_WHILE,
+  N_FOR
+};
+
+struct Node_;
+
+// Where a variable, parameter or function result is stored, seen from the
+// scope of the statement using it: follow depth static links, then take
+// the word at offset in that frame
+struct Address_ {
+  int depth;
+  int offset;
+};
+
+typedef struct Address_ Address;
+
+struct NodeList_ {
+  struct Node_ *node;
+  struct NodeList_ *next;
+};
+
+typedef struct NodeList_ NodeList;
+
+struct Node_ {
+  enum NodeKind kind;
+  int lineNo, colNo;
+  Type *type;                   // of an expression, set as it is built
+  union {
+    int value;                                                     // N_NUMBER, N_CHAR
+    struct { Object *obj; NodeList *indexes; Address addr; } var;   // N_CONSTANT, N_VARIABLE
+    struct { Object *obj; NodeList *args; } call;                   // N_FUNCTION_CALL, N_CALL
+    struct { TokenType op; struct Node_ *operand; } unary;          // N_UNARY
+    struct { TokenType op; struct Node_ *left, *right; } binary;    // N_BINARY, N_CONDITION
+    struct { struct Node_ *lvalue, *expr; } assign;                 // N_ASSIGN
+    struct { NodeList *stmts; } group;                              // N_GROUP
+    struct { struct Node_ *cond, *thenSt, *elseSt; } ifSt;          // N_IF
+    struct { struct Node_ *cond, *body; } whileSt;                  // N_WHILE
+    struct { Object *var; Address addr; struct Node_ *from, *to, *body; } forSt;  // N_FOR
+  };
+};
+
+typedef struct Node_ Node;
+
+// Nodes and list cells are allocated from *nodeArena, which initAST()
+// points at the compilation's own arena (see parallel.c for the others)
+extern _Thread_local Arena* nodeArena;
+
+void initAST(void);
+void freeAST(void);
+
+Node* makeNode(enum NodeKind kind, int lineNo, int colNo);
+NodeList** appendNode(NodeList** tail, Node* node);
+
+void walkTree(Node* root, void (*visit)(Node* node));
+
+#endif
@@ -0,0 +1,386 @@
+/*
+ * @copyright (c) 2026
+ * @author agent <agent@local>
+ * @version 1.0
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "tokenwin.h"
+#include "bodycache.h"
+
+#define INIT_CACHE_SIZE 256
+
+extern _Thread_local SymTab* symtab;
+
+int incremental = 0;
+
+struct Relocation {
+  Object** slot;
+  int index;
+};
+
+CachedBody** cacheBuckets = NULL;
+int cacheSize = 0;
+int cacheCount = 0;
+
+/******************* Keys ******************************/
+
+unsigned long long hashInt(unsigned long long hash, int n) {
+  int i;
+
+  for (i = 0; i < 4; i++) {
+    hash ^= (n >> (8 * i)) & 0xFF;
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+// Fold the tokens from index from up to (not including) to into hash.
+// Positions are taken relative to baseLine, or left out when it is 0.
+unsigned long long hashTokens(unsigned long long hash, int from, int to, int baseLine) {
+  Token* token;
+  char* s;
+  int i;
+
+  for (i = from; i < to; i++) {
+    token = tokenAt(i);
+    hash = hashInt(hash, token->tokenType);
+    switch (token->tokenType) {
+    case TK_NUMBER:
+      hash = hashInt(hash, token->value);
+      break;
+    case TK_IDENT:
+    case TK_CHAR:
+      for (s = token->string; *s != '\0'; s++) {
+	hash ^= (unsigned char) *s;
+	hash *= 1099511628211ULL;
+      }
+      break;
+    default:
+      break;
+    }
+    if (baseLine != 0) {
+      hash = hashInt(hash, token->lineNo - baseLine);
+      hash = hashInt(hash, token->colNo);
+    }
+  }
+  return hash;
+}
+
+/******************* Table ******************************/
+
+void growBodyCache(void) {
+  int newSize = (cacheSize == 0) ? INIT_CACHE_SIZE : 2 * cacheSize;
+  CachedBody** newBuckets = (CachedBody**) calloc(newSize, sizeof(CachedBody*));
+  CachedBody *entry, *next;
+  int i;
+
+  for (i = 0; i < cacheSize; i++)
+    for (entry = cacheBuckets[i]; entry != NULL; entry = next) {
+      next = entry->next;
+      entry->next = newBuckets[entry->key & (newSize - 1)];
+      newBuckets[entry->key & (newSize - 1)] = entry;
+    }
+  free(cacheBuckets);
+  cacheBuckets = newBuckets;
+  cacheSize = newSize;
+}
+
+CachedBody* findCachedBody(unsigned long long key) {
+  CachedBody* entry;
+
+  if (cacheSize == 0) return NULL;
+  for (entry = cacheBuckets[key & (cacheSize - 1)]; entry != NULL; entry = entry->next)
+    if (entry->key == key) return entry;
+  return NULL;
+}
+
+void insertCachedBody(CachedBody* entry) {
+  if (cacheCount >= cacheSize)
+    growBodyCache();
+  entry->next = cacheBuckets[entry->key & (cacheSize - 1)];
+  cacheBuckets[entry->key & (cacheSize - 1)] = entry;
+  cacheCount ++;
+}
+
+void freeCachedBody(CachedBody* entry) {
+  freeArena(entry->arena);
+  free(entry->arena);
+  free(entry->relocations);
+  free(entry);
+}
+
+/******************* Walking a block ******************************/
+
+Scope** scopeStack = NULL;
+int scopeStackSize = 0;
+
+// Call visit on every object of scope and of the scopes nested in it
+void forEachObject(Scope* scope, void (*visit)(Object* obj)) {
+  ObjectNode* node;
+  int top = 0;
+
+  if (scopeStackSize == 0) {
+    scopeStackSize = 16;
+    scopeStack = (Scope**) malloc(scopeStackSize * sizeof(Scope*));
+  }
+  scopeStack[top++] = scope;
+  while (top > 0) {
+    scope = scopeStack[--top];
+    for (node = scope->objList; node != NULL; node = node->next) {
+      visit(node->object);
+      if ((node->object->kind != OBJ_FUNCTION) && (node->object->kind != OBJ_PROCEDURE))
+	continue;
+      if (top == scopeStackSize) {
+	scopeStackSize *= 2;
+	scopeStack = (Scope**) realloc(scopeStack, scopeStackSize * sizeof(Scope*));
+      }
+      if (node->object->kind == OBJ_FUNCTION)
+	scopeStack[top++] = node->object->funcAttrs.scope;
+      else scopeStack[top++] = node->object->procAttrs.scope;
+    }
+  }
+}
+
+Node* bodyOf(Object* obj) {
+  switch (obj->kind) {
+  case OBJ_FUNCTION:
+    return obj->funcAttrs.body;
+  case OBJ_PROCEDURE:
+    return obj->procAttrs.body;
+  default:
+    return NULL;
+  }
+}
+
+/******************* Relocations ******************************/
+
+// Positions of the objects of the program scope and of the predefined
+// objects in the current compilation
+Object** programObjects = NULL;
+Object** globalObjects = NULL;
+
+// Open addressing map from those objects to their encoded positions
+Object** mapKeys = NULL;
+int* mapIndexes = NULL;
+int mapSize = 0;
+
+CachedBody* recording;
+
+int pointerSlot(Object* obj) {
+  uintptr_t h = ((uintptr_t) obj >> 4) * 0x9E3779B97F4A7C15ULL;
+  int i = (int) (h >> 20) & (mapSize - 1);
+
+  while ((mapKeys[i] != NULL) && (mapKeys[i] != obj))
+    i = (i + 1) & (mapSize - 1);
+  return i;
+}
+
+Object** listObjects(ObjectNode* list, int* count) {
+  Object** objects;
+  ObjectNode* node;
+  int n = 0;
+
+  for (node = list; node != NULL; node = node->next) n ++;
+  objects = (Object**) malloc((n + 1) * sizeof(Object*));
+  n = 0;
+  for (node = list; node != NULL; node = node->next)
+    objects[n++] = node->object;
+  *count = n;
+  return objects;
+}
+
+void buildObjectMap(int programCount, int globalCount) {
+  int i;
+
+  mapSize = 16;
+  while (mapSize < 2 * (programCount + globalCount)) mapSize *= 2;
+  mapKeys = (Object**) calloc(mapSize, sizeof(Object*));
+  mapIndexes = (int*) malloc(mapSize * sizeof(int));
+
+  for (i = 0; i < programCount; i++) {
+    int slot = pointerSlot(programObjects[i]);
+    mapKeys[slot] = programObjects[i];
+    mapIndexes[slot] = i;
+  }
+  for (i = 0; i < globalCount; i++) {
+    int slot = pointerSlot(globalObjects[i]);
+    mapKeys[slot] = globalObjects[i];
+    mapIndexes[slot] = -1 - i;
+  }
+}
+
+void recordSlot(Object** slot) {
+  int i;
+
+  if (*slot == NULL) return;
+  i = pointerSlot(*slot);
+  if (mapKeys[i] == NULL) return;
+
+  if ((recording->relocationCount & (recording->relocationCount - 1)) == 0)
+    recording->relocations = (struct Relocation*)
+      realloc(recording->relocations, (recording->relocationCount == 0 ? 1 : 2 * recording->relocationCount) * sizeof(struct Relocation));
+  recording->relocations[recording->relocationCount].slot = slot;
+  recording->relocations[recording->relocationCount].index = mapIndexes[i];
+  recording->relocationCount ++;
+}
+
+void recordNode(Node* node) {
+  switch (node->kind) {
+  case N_CONSTANT:
+  case N_VARIABLE:
+    recordSlot(&node->var.obj);
+    break;
+  case N_FUNCTION_CALL:
+  case N_CALL:
+    recordSlot(&node->call.obj);
+    break;
+  case N_FOR:
+    recordSlot(&node->forSt.var);
+    break;
+  default:
+    break;
+  }
+}
+
+void recordObject(Object* obj) {
+  if (obj->kind == OBJ_PARAMETER)
+    recordSlot(&obj->paramAttrs.function);
+  else if (bodyOf(obj) != NULL)
+    walkTree(bodyOf(obj), recordNode);
+}
+
+int lineDelta;
+
+void shiftNode(Node* node) {
+  node->lineNo += lineDelta;
+}
+
+void shiftObject(Object* obj) {
+  if (bodyOf(obj) != NULL)
+    walkTree(bodyOf(obj), shiftNode);
+}
+
+/******************* Updating ******************************/
+
+// Give a fresh subprogram object the cached scope, parameters and body
+// of its previous version. Its own are left in the task's arena.
+void reuseBody(CachedBody* entry, struct BodyTask* task) {
+  Object* owner = task->owner;
+  int i;
+
+  if (owner->kind == OBJ_FUNCTION) {
+    owner->funcAttrs.scope = entry->scope;
+    owner->funcAttrs.paramList = entry->paramList;
+    owner->funcAttrs.lastParam = entry->lastParam;
+    owner->funcAttrs.body = entry->body;
+  } else {
+    owner->procAttrs.scope = entry->scope;
+    owner->procAttrs.paramList = entry->paramList;
+    owner->procAttrs.lastParam = entry->lastParam;
+    owner->procAttrs.body = entry->body;
+  }
+  entry->scope->owner = owner;
+  entry->scope->outer = symtab->program->progAttrs.scope;
+  for (i = 0; i < entry->relocationCount; i++) {
+    int index = entry->relocations[i].index;
+    *(entry->relocations[i].slot) = (index >= 0) ? programObjects[index] : globalObjects[-1 - index];
+  }
+
+  if (task->lineNo != entry->lineNo) {
+    lineDelta = task->lineNo - entry->lineNo;
+    walkTree(entry->body, shiftNode);
+    forEachObject(entry->scope, shiftObject);
+    entry->lineNo = task->lineNo;
+  }
+  entry->used = 1;
+}
+
+void storeBody(struct BodyTask* task) {
+  CachedBody* entry = (CachedBody*) malloc(sizeof(CachedBody));
+  Object* owner = task->owner;
+
+  entry->key = task->key;
+  entry->lineNo = task->lineNo;
+  if (owner->kind == OBJ_FUNCTION) {
+    entry->scope = owner->funcAttrs.scope;
+    entry->paramList = owner->funcAttrs.paramList;
+    entry->lastParam = owner->funcAttrs.lastParam;
+  } else {
+    entry->scope = owner->procAttrs.scope;
+    entry->paramList = owner->procAttrs.paramList;
+    entry->lastParam = owner->procAttrs.lastParam;
+  }
+  entry->body = task->body;
+  entry->arena = task->arena;
+  task->arena = NULL;
+  entry->relocations = NULL;
+  entry->relocationCount = 0;
+  entry->used = 1;
+
+  recording = entry;
+  walkTree(entry->body, recordNode);
+  forEachObject(entry->scope, recordObject);
+  insertCachedBody(entry);
+}
+
+// After a successful compilation: attach the reused blocks to their
+// subprograms, keep the newly parsed ones and drop the rest
+void updateBodyCache(struct BodyTask* tasks, int count) {
+  CachedBody **link, *entry;
+  int programCount, globalCount;
+  int i;
+
+  programObjects = listObjects(symtab->program->progAttrs.scope->objList, &programCount);
+  globalObjects = listObjects(symtab->globalObjectList, &globalCount);
+
+  for (i = 0; i < count; i++)
+    if (tasks[i].cached != NULL)
+      reuseBody(tasks[i].cached, &tasks[i]);
+
+  buildObjectMap(programCount, globalCount);
+  for (i = 0; i < count; i++)
+    if (tasks[i].cached == NULL)
+      storeBody(&tasks[i]);
+
+  for (i = 0; i < cacheSize; i++) {
+    link = &cacheBuckets[i];
+    while ((entry = *link) != NULL) {
+      if (entry->used) {
+	entry->used = 0;
+	link = &entry->next;
+      } else {
+	*link = entry->next;
+	freeCachedBody(entry);
+	cacheCount --;
+      }
+    }
+  }
+
+  free(programObjects);
+  free(globalObjects);
+  free(mapKeys);
+  free(mapIndexes);
+  programObjects = globalObjects = mapKeys = NULL;
+  mapIndexes = NULL;
+}
+
+void freeBodyCache(void) {
+  CachedBody *entry, *next;
+  int i;
+
+  for (i = 0; i < cacheSize; i++)
+    for (entry = cacheBuckets[i]; entry != NULL; entry = next) {
+      next = entry->next;
+      freeCachedBody(entry);
+    }
+  free(cacheBuckets);
+  cacheBuckets = NULL;
+  cacheSize = 0;
+  cacheCount = 0;
+  free(scopeStack);
+  scopeStack = NULL;
+  scopeStackSize = 0;
+}
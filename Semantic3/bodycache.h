@@ -0,0 +1,47 @@
+/*
+ * @copyright (c) 2026
+ * @author agent <agent@local>
+ * @version 1.0
+ */
+
+#ifndef __BODYCACHE_H__
+#define __BODYCACHE_H__
+
+#include "parallel.h"
+
+#define HASH_BASIS 14695981039346656037ULL
+
+// When set, the parsed blocks of the program's functions and procedures
+// are kept after compile() returns. The next compile() reuses a block
+// when its tokens and every declaration visible to it are unchanged.
+extern int incremental;
+
+// The result of parsing one block: the subprogram's scope with its
+// parameters, local objects and nested subprograms, and its body
+struct CachedBody_ {
+  unsigned long long key;
+  int lineNo;                   // where the block's header was
+  Scope* scope;
+  ObjectNode* paramList;
+  ObjectNode* lastParam;
+  Node* body;
+  Arena* arena;                 // the scope and everything in it, the nodes
+                                // of body and of nested bodies
+  // Places that refer to objects outside the block, with the position of
+  // each object in the program scope (or -1 - position among the
+  // predefined objects), so they can be pointed at the next compilation's
+  // objects
+  struct Relocation *relocations;
+  int relocationCount;
+  int used;
+  struct CachedBody_ *next;
+};
+
+typedef struct CachedBody_ CachedBody;
+
+unsigned long long hashTokens(unsigned long long hash, int from, int to, int baseLine);
+CachedBody* findCachedBody(unsigned long long key);
+void updateBodyCache(struct BodyTask* tasks, int count);
+void freeBodyCache(void);
+
+#endif
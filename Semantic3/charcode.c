@@ -6,44 +6,70 @@
 
 #include "charcode.h"
 
-CharCode charCodes[256] = {
-  CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN,
-  CHAR_UNKNOWN, CHAR_SPACE, CHAR_SPACE, CHAR_SPACE, CHAR_SPACE, CHAR_SPACE, CHAR_UNKNOWN, CHAR_UNKNOWN,
-  CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN,
-  CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN,
-
-  CHAR_SPACE, CHAR_EXCLAIMATION, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_SINGLEQUOTE,
-  CHAR_LPAR, CHAR_RPAR, CHAR_TIMES, CHAR_PLUS, CHAR_COMMA, CHAR_MINUS, CHAR_PERIOD, CHAR_SLASH,
-  CHAR_DIGIT, CHAR_DIGIT, CHAR_DIGIT, CHAR_DIGIT, CHAR_DIGIT, CHAR_DIGIT, CHAR_DIGIT, CHAR_DIGIT,
-  CHAR_DIGIT, CHAR_DIGIT, CHAR_COLON, CHAR_SEMICOLON, CHAR_LT, CHAR_EQ, CHAR_GT, CHAR_UNKNOWN,
-
-  CHAR_UNKNOWN, CHAR_LETTER, CHAR_LETTER, CHAR_LETTER, CHAR_LETTER, CHAR_LETTER, CHAR_LETTER, CHAR_LETTER,
-  CHAR_LETTER, CHAR_LETTER, CHAR_LETTER, CHAR_LETTER, CHAR_LETTER, CHAR_LETTER, CHAR_LETTER, CHAR_LETTER,
-  CHAR_LETTER, CHAR_LETTER, CHAR_LETTER, CHAR_LETTER, CHAR_LETTER, CHAR_LETTER, CHAR_LETTER, CHAR_LETTER,
-  CHAR_LETTER, CHAR_LETTER, CHAR_LETTER, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN,
-
-  CHAR_UNKNOWN, CHAR_LETTER, CHAR_LETTER, CHAR_LETTER, CHAR_LETTER, CHAR_LETTER, CHAR_LETTER, CHAR_LETTER,
-  CHAR_LETTER, CHAR_LETTER, CHAR_LETTER, CHAR_LETTER, CHAR_LETTER, CHAR_LETTER, CHAR_LETTER, CHAR_LETTER,
-  CHAR_LETTER, CHAR_LETTER, CHAR_LETTER, CHAR_LETTER, CHAR_LETTER, CHAR_LETTER, CHAR_LETTER, CHAR_LETTER,
-  CHAR_LETTER, CHAR_LETTER, CHAR_LETTER, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN,
-
-  CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN,
-  CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN,
-  CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN,
-  CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN,
-
-  CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN,
-  CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN,
-  CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN,
-  CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN,
-
-  CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN,
-  CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN,
-  CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN,
-  CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN,
-
-  CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN,
-  CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN,
-  CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN,
-  CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN, CHAR_UNKNOWN
+// Character class, upper-case fold and identifier flag of every byte
+CharInfo charInfo[256] = {
+  {CHAR_UNKNOWN, 0x00, 0}, {CHAR_UNKNOWN, 0x01, 0}, {CHAR_UNKNOWN, 0x02, 0}, {CHAR_UNKNOWN, 0x03, 0},
+  {CHAR_UNKNOWN, 0x04, 0}, {CHAR_UNKNOWN, 0x05, 0}, {CHAR_UNKNOWN, 0x06, 0}, {CHAR_UNKNOWN, 0x07, 0},
+  {CHAR_UNKNOWN, 0x08, 0}, {CHAR_SPACE, 0x09, 0}, {CHAR_SPACE, 0x0A, 0}, {CHAR_SPACE, 0x0B, 0},
+  {CHAR_SPACE, 0x0C, 0}, {CHAR_SPACE, 0x0D, 0}, {CHAR_UNKNOWN, 0x0E, 0}, {CHAR_UNKNOWN, 0x0F, 0},
+  {CHAR_UNKNOWN, 0x10, 0}, {CHAR_UNKNOWN, 0x11, 0}, {CHAR_UNKNOWN, 0x12, 0}, {CHAR_UNKNOWN, 0x13, 0},
+  {CHAR_UNKNOWN, 0x14, 0}, {CHAR_UNKNOWN, 0x15, 0}, {CHAR_UNKNOWN, 0x16, 0}, {CHAR_UNKNOWN, 0x17, 0},
+  {CHAR_UNKNOWN, 0x18, 0}, {CHAR_UNKNOWN, 0x19, 0}, {CHAR_UNKNOWN, 0x1A, 0}, {CHAR_UNKNOWN, 0x1B, 0},
+  {CHAR_UNKNOWN, 0x1C, 0}, {CHAR_UNKNOWN, 0x1D, 0}, {CHAR_UNKNOWN, 0x1E, 0}, {CHAR_UNKNOWN, 0x1F, 0},
+  {CHAR_SPACE, 0x20, 0}, {CHAR_EXCLAIMATION, 0x21, 0}, {CHAR_UNKNOWN, 0x22, 0}, {CHAR_UNKNOWN, 0x23, 0},
+  {CHAR_UNKNOWN, 0x24, 0}, {CHAR_UNKNOWN, 0x25, 0}, {CHAR_UNKNOWN, 0x26, 0}, {CHAR_SINGLEQUOTE, 0x27, 0},
+  {CHAR_LPAR, 0x28, 0}, {CHAR_RPAR, 0x29, 0}, {CHAR_TIMES, 0x2A, 0}, {CHAR_PLUS, 0x2B, 0},
+  {CHAR_COMMA, 0x2C, 0}, {CHAR_MINUS, 0x2D, 0}, {CHAR_PERIOD, 0x2E, 0}, {CHAR_SLASH, 0x2F, 0},
+  {CHAR_DIGIT, 0x30, 1}, {CHAR_DIGIT, 0x31, 1}, {CHAR_DIGIT, 0x32, 1}, {CHAR_DIGIT, 0x33, 1},
+  {CHAR_DIGIT, 0x34, 1}, {CHAR_DIGIT, 0x35, 1}, {CHAR_DIGIT, 0x36, 1}, {CHAR_DIGIT, 0x37, 1},
+  {CHAR_DIGIT, 0x38, 1}, {CHAR_DIGIT, 0x39, 1}, {CHAR_COLON, 0x3A, 0}, {CHAR_SEMICOLON, 0x3B, 0},
+  {CHAR_LT, 0x3C, 0}, {CHAR_EQ, 0x3D, 0}, {CHAR_GT, 0x3E, 0}, {CHAR_UNKNOWN, 0x3F, 0},
+  {CHAR_UNKNOWN, 0x40, 0}, {CHAR_LETTER, 0x41, 1}, {CHAR_LETTER, 0x42, 1}, {CHAR_LETTER, 0x43, 1},
+  {CHAR_LETTER, 0x44, 1}, {CHAR_LETTER, 0x45, 1}, {CHAR_LETTER, 0x46, 1}, {CHAR_LETTER, 0x47, 1},
+  {CHAR_LETTER, 0x48, 1}, {CHAR_LETTER, 0x49, 1}, {CHAR_LETTER, 0x4A, 1}, {CHAR_LETTER, 0x4B, 1},
+  {CHAR_LETTER, 0x4C, 1}, {CHAR_LETTER, 0x4D, 1}, {CHAR_LETTER, 0x4E, 1}, {CHAR_LETTER, 0x4F, 1},
+  {CHAR_LETTER, 0x50, 1}, {CHAR_LETTER, 0x51, 1}, {CHAR_LETTER, 0x52, 1}, {CHAR_LETTER, 0x53, 1},
+  {CHAR_LETTER, 0x54, 1}, {CHAR_LETTER, 0x55, 1}, {CHAR_LETTER, 0x56, 1}, {CHAR_LETTER, 0x57, 1},
+  {CHAR_LETTER, 0x58, 1}, {CHAR_LETTER, 0x59, 1}, {CHAR_LETTER, 0x5A, 1}, {CHAR_UNKNOWN, 0x5B, 0},
+  {CHAR_UNKNOWN, 0x5C, 0}, {CHAR_UNKNOWN, 0x5D, 0}, {CHAR_UNKNOWN, 0x5E, 0}, {CHAR_UNKNOWN, 0x5F, 0},
+  {CHAR_UNKNOWN, 0x60, 0}, {CHAR_LETTER, 0x41, 1}, {CHAR_LETTER, 0x42, 1}, {CHAR_LETTER, 0x43, 1},
+  {CHAR_LETTER, 0x44, 1}, {CHAR_LETTER, 0x45, 1}, {CHAR_LETTER, 0x46, 1}, {CHAR_LETTER, 0x47, 1},
+  {CHAR_LETTER, 0x48, 1}, {CHAR_LETTER, 0x49, 1}, {CHAR_LETTER, 0x4A, 1}, {CHAR_LETTER, 0x4B, 1},
+  {CHAR_LETTER, 0x4C, 1}, {CHAR_LETTER, 0x4D, 1}, {CHAR_LETTER, 0x4E, 1}, {CHAR_LETTER, 0x4F, 1},
+  {CHAR_LETTER, 0x50, 1}, {CHAR_LETTER, 0x51, 1}, {CHAR_LETTER, 0x52, 1}, {CHAR_LETTER, 0x53, 1},
+  {CHAR_LETTER, 0x54, 1}, {CHAR_LETTER, 0x55, 1}, {CHAR_LETTER, 0x56, 1}, {CHAR_LETTER, 0x57, 1},
+  {CHAR_LETTER, 0x58, 1}, {CHAR_LETTER, 0x59, 1}, {CHAR_LETTER, 0x5A, 1}, {CHAR_UNKNOWN, 0x7B, 0},
+  {CHAR_UNKNOWN, 0x7C, 0}, {CHAR_UNKNOWN, 0x7D, 0}, {CHAR_UNKNOWN, 0x7E, 0}, {CHAR_UNKNOWN, 0x7F, 0},
+  {CHAR_UNKNOWN, 0x80, 0}, {CHAR_UNKNOWN, 0x81, 0}, {CHAR_UNKNOWN, 0x82, 0}, {CHAR_UNKNOWN, 0x83, 0},
+  {CHAR_UNKNOWN, 0x84, 0}, {CHAR_UNKNOWN, 0x85, 0}, {CHAR_UNKNOWN, 0x86, 0}, {CHAR_UNKNOWN, 0x87, 0},
+  {CHAR_UNKNOWN, 0x88, 0}, {CHAR_UNKNOWN, 0x89, 0}, {CHAR_UNKNOWN, 0x8A, 0}, {CHAR_UNKNOWN, 0x8B, 0},
+  {CHAR_UNKNOWN, 0x8C, 0}, {CHAR_UNKNOWN, 0x8D, 0}, {CHAR_UNKNOWN, 0x8E, 0}, {CHAR_UNKNOWN, 0x8F, 0},
+  {CHAR_UNKNOWN, 0x90, 0}, {CHAR_UNKNOWN, 0x91, 0}, {CHAR_UNKNOWN, 0x92, 0}, {CHAR_UNKNOWN, 0x93, 0},
+  {CHAR_UNKNOWN, 0x94, 0}, {CHAR_UNKNOWN, 0x95, 0}, {CHAR_UNKNOWN, 0x96, 0}, {CHAR_UNKNOWN, 0x97, 0},
+  {CHAR_UNKNOWN, 0x98, 0}, {CHAR_UNKNOWN, 0x99, 0}, {CHAR_UNKNOWN, 0x9A, 0}, {CHAR_UNKNOWN, 0x9B, 0},
+  {CHAR_UNKNOWN, 0x9C, 0}, {CHAR_UNKNOWN, 0x9D, 0}, {CHAR_UNKNOWN, 0x9E, 0}, {CHAR_UNKNOWN, 0x9F, 0},
+  {CHAR_UNKNOWN, 0xA0, 0}, {CHAR_UNKNOWN, 0xA1, 0}, {CHAR_UNKNOWN, 0xA2, 0}, {CHAR_UNKNOWN, 0xA3, 0},
+  {CHAR_UNKNOWN, 0xA4, 0}, {CHAR_UNKNOWN, 0xA5, 0}, {CHAR_UNKNOWN, 0xA6, 0}, {CHAR_UNKNOWN, 0xA7, 0},
+  {CHAR_UNKNOWN, 0xA8, 0}, {CHAR_UNKNOWN, 0xA9, 0}, {CHAR_UNKNOWN, 0xAA, 0}, {CHAR_UNKNOWN, 0xAB, 0},
+  {CHAR_UNKNOWN, 0xAC, 0}, {CHAR_UNKNOWN, 0xAD, 0}, {CHAR_UNKNOWN, 0xAE, 0}, {CHAR_UNKNOWN, 0xAF, 0},
+  {CHAR_UNKNOWN, 0xB0, 0}, {CHAR_UNKNOWN, 0xB1, 0}, {CHAR_UNKNOWN, 0xB2, 0}, {CHAR_UNKNOWN, 0xB3, 0},
+  {CHAR_UNKNOWN, 0xB4, 0}, {CHAR_UNKNOWN, 0xB5, 0}, {CHAR_UNKNOWN, 0xB6, 0}, {CHAR_UNKNOWN, 0xB7, 0},
+  {CHAR_UNKNOWN, 0xB8, 0}, {CHAR_UNKNOWN, 0xB9, 0}, {CHAR_UNKNOWN, 0xBA, 0}, {CHAR_UNKNOWN, 0xBB, 0},
+  {CHAR_UNKNOWN, 0xBC, 0}, {CHAR_UNKNOWN, 0xBD, 0}, {CHAR_UNKNOWN, 0xBE, 0}, {CHAR_UNKNOWN, 0xBF, 0},
+  {CHAR_UNKNOWN, 0xC0, 0}, {CHAR_UNKNOWN, 0xC1, 0}, {CHAR_UNKNOWN, 0xC2, 0}, {CHAR_UNKNOWN, 0xC3, 0},
+  {CHAR_UNKNOWN, 0xC4, 0}, {CHAR_UNKNOWN, 0xC5, 0}, {CHAR_UNKNOWN, 0xC6, 0}, {CHAR_UNKNOWN, 0xC7, 0},
+  {CHAR_UNKNOWN, 0xC8, 0}, {CHAR_UNKNOWN, 0xC9, 0}, {CHAR_UNKNOWN, 0xCA, 0}, {CHAR_UNKNOWN, 0xCB, 0},
+  {CHAR_UNKNOWN, 0xCC, 0}, {CHAR_UNKNOWN, 0xCD, 0}, {CHAR_UNKNOWN, 0xCE, 0}, {CHAR_UNKNOWN, 0xCF, 0},
+  {CHAR_UNKNOWN, 0xD0, 0}, {CHAR_UNKNOWN, 0xD1, 0}, {CHAR_UNKNOWN, 0xD2, 0}, {CHAR_UNKNOWN, 0xD3, 0},
+  {CHAR_UNKNOWN, 0xD4, 0}, {CHAR_UNKNOWN, 0xD5, 0}, {CHAR_UNKNOWN, 0xD6, 0}, {CHAR_UNKNOWN, 0xD7, 0},
+  {CHAR_UNKNOWN, 0xD8, 0}, {CHAR_UNKNOWN, 0xD9, 0}, {CHAR_UNKNOWN, 0xDA, 0}, {CHAR_UNKNOWN, 0xDB, 0},
+  {CHAR_UNKNOWN, 0xDC, 0}, {CHAR_UNKNOWN, 0xDD, 0}, {CHAR_UNKNOWN, 0xDE, 0}, {CHAR_UNKNOWN, 0xDF, 0},
+  {CHAR_UNKNOWN, 0xE0, 0}, {CHAR_UNKNOWN, 0xE1, 0}, {CHAR_UNKNOWN, 0xE2, 0}, {CHAR_UNKNOWN, 0xE3, 0},
+  {CHAR_UNKNOWN, 0xE4, 0}, {CHAR_UNKNOWN, 0xE5, 0}, {CHAR_UNKNOWN, 0xE6, 0}, {CHAR_UNKNOWN, 0xE7, 0},
+  {CHAR_UNKNOWN, 0xE8, 0}, {CHAR_UNKNOWN, 0xE9, 0}, {CHAR_UNKNOWN, 0xEA, 0}, {CHAR_UNKNOWN, 0xEB, 0},
+  {CHAR_UNKNOWN, 0xEC, 0}, {CHAR_UNKNOWN, 0xED, 0}, {CHAR_UNKNOWN, 0xEE, 0}, {CHAR_UNKNOWN, 0xEF, 0},
+  {CHAR_UNKNOWN, 0xF0, 0}, {CHAR_UNKNOWN, 0xF1, 0}, {CHAR_UNKNOWN, 0xF2, 0}, {CHAR_UNKNOWN, 0xF3, 0},
+  {CHAR_UNKNOWN, 0xF4, 0}, {CHAR_UNKNOWN, 0xF5, 0}, {CHAR_UNKNOWN, 0xF6, 0}, {CHAR_UNKNOWN, 0xF7, 0},
+  {CHAR_UNKNOWN, 0xF8, 0}, {CHAR_UNKNOWN, 0xF9, 0}, {CHAR_UNKNOWN, 0xFA, 0}, {CHAR_UNKNOWN, 0xFB, 0},
+  {CHAR_UNKNOWN, 0xFC, 0}, {CHAR_UNKNOWN, 0xFD, 0}, {CHAR_UNKNOWN, 0xFE, 0}, {CHAR_UNKNOWN, 0xFF, 0}
 };
@@ -29,4 +29,13 @@ typedef enum {
   CHAR_UNKNOWN
 } CharCode;
 
+typedef struct {
+  unsigned char code;      // CharCode of the byte
+  unsigned char folded;    // the byte converted to upper case
+  unsigned char isIdent;   // non-zero for letters and digits
+  unsigned char reserved;
+} CharInfo;
+
+extern CharInfo charInfo[256];
+
 #endif
@@ -46,42 +46,42 @@ void printObject(Object* obj, int indent) {
   case OBJ_CONSTANT:
     pad(indent);
     printf("Const %s = ", obj->name);
-    printConstantValue(obj->constAttrs->value);
+    printConstantValue(obj->constAttrs.value);
     break;
   case OBJ_TYPE:
     pad(indent);
     printf("Type %s = ", obj->name);
-    printType(obj->typeAttrs->actualType);
+    printType(obj->typeAttrs.actualType);
     break;
   case OBJ_VARIABLE:
     pad(indent);
     printf("Var %s : ", obj->name);
-    printType(obj->varAttrs->type);
+    printType(obj->varAttrs.type);
     break;
   case OBJ_PARAMETER:
     pad(indent);
-    if (obj->paramAttrs->kind == PARAM_VALUE) 
+    if (obj->paramAttrs.kind == PARAM_VALUE) 
       printf("Param %s : ", obj->name);
     else
       printf("Param VAR %s : ", obj->name);
-    printType(obj->paramAttrs->type);
+    printType(obj->paramAttrs.type);
     break;
   case OBJ_FUNCTION:
     pad(indent);
     printf("Function %s : ",obj->name);
-    printType(obj->funcAttrs->returnType);
+    printType(obj->funcAttrs.returnType);
     printf("\n");
-    printScope(obj->funcAttrs->scope, indent + 4);
+    printScope(obj->funcAttrs.scope, indent + 4);
     break;
   case OBJ_PROCEDURE:
     pad(indent);
     printf("Procedure %s\n",obj->name);
-    printScope(obj->procAttrs->scope, indent + 4);
+    printScope(obj->procAttrs.scope, indent + 4);
     break;
   case OBJ_PROGRAM:
     pad(indent);
     printf("Program %s\n",obj->name);
-    printScope(obj->progAttrs->scope, indent + 4);
+    printScope(obj->progAttrs.scope, indent + 4);
     break;
   }
 }
@@ -99,3 +99,175 @@ void printScope(Scope* scope, int indent) {
   printObjectList(scope->objList, indent);
 }
 
+
+/******************* Syntax tree ******************************/
+
+char* opToString(TokenType op) {
+  switch (op) {
+  case SB_PLUS: return "+";
+  case SB_MINUS: return "-";
+  case SB_TIMES: return "*";
+  case SB_SLASH: return "/";
+  case SB_EQ: return "=";
+  case SB_NEQ: return "!=";
+  case SB_LT: return "<";
+  case SB_LE: return "<=";
+  case SB_GT: return ">";
+  case SB_GE: return ">=";
+  default: return "?";
+  }
+}
+
+void printArguments(NodeList* args) {
+  if (args == NULL) return;
+  printf("(");
+  while (args != NULL) {
+    printExpression(args->node);
+    if (args->next != NULL) printf(",");
+    args = args->next;
+  }
+  printf(")");
+}
+
+// Static links to follow, then the word in that frame
+void printAddress(Address* addr) {
+  printf("@(%d,%d)", addr->depth, addr->offset);
+}
+
+void printExpression(Node* node) {
+  NodeList* index;
+
+  switch (node->kind) {
+  case N_NUMBER:
+    printf("%d", node->value);
+    break;
+  case N_CHAR:
+    printf("\'%c\'", node->value);
+    break;
+  case N_CONSTANT:
+  case N_VARIABLE:
+    printf("%s", node->var.obj->name);
+    if (node->kind == N_VARIABLE)
+      printAddress(&(node->var.addr));
+    for (index = node->var.indexes; index != NULL; index = index->next) {
+      printf("(.");
+      printExpression(index->node);
+      printf(".)");
+    }
+    break;
+  case N_FUNCTION_CALL:
+    printf("%s", node->call.obj->name);
+    printArguments(node->call.args);
+    break;
+  case N_UNARY:
+    printf("(%s", opToString(node->unary.op));
+    printExpression(node->unary.operand);
+    printf(")");
+    break;
+  case N_BINARY:
+    printf("(");
+    printExpression(node->binary.left);
+    printf(" %s ", opToString(node->binary.op));
+    printExpression(node->binary.right);
+    printf(")");
+    break;
+  case N_CONDITION:
+    printExpression(node->binary.left);
+    printf(" %s ", opToString(node->binary.op));
+    printExpression(node->binary.right);
+    break;
+  default:
+    break;
+  }
+}
+
+void printStatement(Node* node, int indent) {
+  NodeList* stmt;
+
+  switch (node->kind) {
+  case N_EMPTY:
+    break;
+  case N_ASSIGN:
+    pad(indent);
+    printExpression(node->assign.lvalue);
+    printf(" := ");
+    printExpression(node->assign.expr);
+    printf("\n");
+    break;
+  case N_CALL:
+    pad(indent);
+    printf("CALL %s", node->call.obj->name);
+    printArguments(node->call.args);
+    printf("\n");
+    break;
+  case N_GROUP:
+    pad(indent);
+    printf("BEGIN\n");
+    for (stmt = node->group.stmts; stmt != NULL; stmt = stmt->next)
+      printStatement(stmt->node, indent + 4);
+    pad(indent);
+    printf("END\n");
+    break;
+  case N_IF:
+    pad(indent);
+    printf("IF ");
+    printExpression(node->ifSt.cond);
+    printf(" THEN\n");
+    printStatement(node->ifSt.thenSt, indent + 4);
+    if (node->ifSt.elseSt != NULL) {
+      pad(indent);
+      printf("ELSE\n");
+      printStatement(node->ifSt.elseSt, indent + 4);
+    }
+    break;
+  case N_WHILE:
+    pad(indent);
+    printf("WHILE ");
+    printExpression(node->whileSt.cond);
+    printf(" DO\n");
+    printStatement(node->whileSt.body, indent + 4);
+    break;
+  case N_FOR:
+    pad(indent);
+    printf("FOR %s", node->forSt.var->name);
+    printAddress(&(node->forSt.addr));
+    printf(" := ");
+    printExpression(node->forSt.from);
+    printf(" TO ");
+    printExpression(node->forSt.to);
+    printf(" DO\n");
+    printStatement(node->forSt.body, indent + 4);
+    break;
+  default:
+    break;
+  }
+}
+
+// Print the body of a program or subprogram, then those of its subprograms
+void printBodies(Object* obj) {
+  Scope* scope;
+  Node* body;
+  ObjectNode* node;
+
+  switch (obj->kind) {
+  case OBJ_PROGRAM:
+    scope = obj->progAttrs.scope;
+    body = obj->progAttrs.body;
+    break;
+  case OBJ_FUNCTION:
+    scope = obj->funcAttrs.scope;
+    body = obj->funcAttrs.body;
+    break;
+  case OBJ_PROCEDURE:
+    scope = obj->procAttrs.scope;
+    body = obj->procAttrs.body;
+    break;
+  default:
+    return;
+  }
+
+  printf("Body of %s (level %d, frame %d)\n", obj->name, scope->level, scope->frameSize);
+  if (body != NULL) printStatement(body, 4);
+  for (node = scope->objList; node != NULL; node = node->next)
+    printBodies(node->object);
+}
@@ -8,14 +8,14 @@
 #include <stdlib.h>
 #include "error.h"
 
-#define NUM_OF_ERRORS 29
+#define NUM_OF_ERRORS 33
 
 struct ErrorMessage {
   ErrorCode errorCode;
   char *message;
 };
 
-struct ErrorMessage errors[29] = {
+struct ErrorMessage errors[NUM_OF_ERRORS] = {
   {ERR_END_OF_COMMENT, "End of comment expected."},
   {ERR_IDENT_TOO_LONG, "Identifier too long."},
   {ERR_INVALID_CONSTANT_CHAR, "Invalid char constant."},
@@ -44,21 +44,112 @@ struct ErrorMessage errors[29] = {
   {ERR_UNDECLARED_PROCEDURE, "Undeclared procedure."},
   {ERR_DUPLICATE_IDENT, "Duplicate identifier."},
   {ERR_TYPE_INCONSISTENCY, "Type inconsistency"},
-  {ERR_PARAMETERS_ARGUMENTS_INCONSISTENCY, "The number of arguments and the number of parameters are inconsistent."}
+  {ERR_PARAMETERS_ARGUMENTS_INCONSISTENCY, "The number of arguments and the number of parameters are inconsistent."},
+  {ERR_DIVISION_BY_ZERO, "Division by zero."},
+  {ERR_CONSTANT_OVERFLOW, "Constant overflow."},
+  {ERR_INVALID_ARRAY_SIZE, "Invalid array size."},
+  {ERR_FRAME_TOO_LARGE, "Frame too large."}
 };
 
-void error(ErrorCode err, int lineNo, int colNo) {
+struct Diagnostic {
+  int lineNo, colNo;
+  int order;
+  ErrorCode errorCode;
+  TokenType missing;   // TK_NONE unless this is a missing token
+};
+
+struct Diagnostic diagnostics[MAX_ERRORS];
+int diagnosticCount = 0;
+
+_Thread_local jmp_buf *recoveryPoint = NULL;
+_Thread_local jmp_buf *abortPoint = NULL;
+_Thread_local jmp_buf *stopPoint = NULL;
+
+char* errorMessage(ErrorCode err) {
   int i;
   for (i = 0 ; i < NUM_OF_ERRORS; i ++) 
-    if (errors[i].errorCode == err) {
-      printf("%d-%d:%s\n", lineNo, colNo, errors[i].message);
-      exit(0);
-    }
+    if (errors[i].errorCode == err) 
+      return errors[i].message;
+  return "";
+}
+
+int compareDiagnostics(const void *a, const void *b) {
+  const struct Diagnostic *d1 = (const struct Diagnostic*) a;
+  const struct Diagnostic *d2 = (const struct Diagnostic*) b;
+
+  if (d1->lineNo != d2->lineNo) return d1->lineNo - d2->lineNo;
+  if (d1->colNo != d2->colNo) return d1->colNo - d2->colNo;
+  return d1->order - d2->order;
+}
+
+void printErrors(void) {
+  int i;
+
+  qsort(diagnostics, diagnosticCount, sizeof(struct Diagnostic), compareDiagnostics);
+  for (i = 0; i < diagnosticCount; i++) {
+    if (diagnostics[i].missing != TK_NONE)
+      printf("%d-%d:Missing %s\n", diagnostics[i].lineNo, diagnostics[i].colNo,
+	     tokenToString(diagnostics[i].missing));
+    else
+      printf("%d-%d:%s\n", diagnostics[i].lineNo, diagnostics[i].colNo,
+	     errorMessage(diagnostics[i].errorCode));
+  }
+}
+
+int errorCount(void) {
+  return diagnosticCount;
+}
+
+void clearErrors(void) {
+  diagnosticCount = 0;
+}
+
+// Record a diagnostic. An error at or before the position of the previous
+// one is most likely a consequence of it and is dropped.
+void addDiagnostic(ErrorCode err, TokenType missing, int lineNo, int colNo) {
+  struct Diagnostic *last;
+
+  if (diagnosticCount > 0) {
+    last = &diagnostics[diagnosticCount - 1];
+    if ((lineNo < last->lineNo) || ((lineNo == last->lineNo) && (colNo <= last->colNo)))
+      return;
+  }
+
+  diagnostics[diagnosticCount].lineNo = lineNo;
+  diagnostics[diagnosticCount].colNo = colNo;
+  diagnostics[diagnosticCount].order = diagnosticCount;
+  diagnostics[diagnosticCount].errorCode = err;
+  diagnostics[diagnosticCount].missing = missing;
+  diagnosticCount ++;
+}
+
+void recover(void) {
+  if ((recoveryPoint == NULL) || (diagnosticCount >= MAX_ERRORS)) {
+    if (stopPoint != NULL) longjmp(*stopPoint, 1);
+    printErrors();
+    exit(0);
+  }
+  longjmp(*recoveryPoint, 1);
+}
+
+// Record an error that needs no resynchronization, such as an invalid
+// token the scanner has already skipped
+void reportError(ErrorCode err, int lineNo, int colNo) {
+  if (abortPoint != NULL) longjmp(*abortPoint, 1);
+  addDiagnostic(err, TK_NONE, lineNo, colNo);
+  if (diagnosticCount >= MAX_ERRORS) recover();
+}
+
+void error(ErrorCode err, int lineNo, int colNo) {
+  if (abortPoint != NULL) longjmp(*abortPoint, 1);
+  addDiagnostic(err, TK_NONE, lineNo, colNo);
+  recover();
 }
 
 void missingToken(TokenType tokenType, int lineNo, int colNo) {
-  printf("%d-%d:Missing %s\n", lineNo, colNo, tokenToString(tokenType));
-  exit(0);
+  if (abortPoint != NULL) longjmp(*abortPoint, 1);
+  addDiagnostic(ERR_INVALID_SYMBOL, tokenType, lineNo, colNo);
+  recover();
 }
 
 void assert(char *msg) {
@@ -6,8 +6,12 @@
 
 #ifndef __ERROR_H__
 #define __ERROR_H__
+#include <setjmp.h>
 #include "token.h"
 
+// Compilation stops once this many errors have been reported
+#define MAX_ERRORS 20
+
 typedef enum {
   ERR_END_OF_COMMENT,
   ERR_IDENT_TOO_LONG,
@@ -37,11 +41,33 @@ typedef enum {
   ERR_UNDECLARED_PROCEDURE,
   ERR_DUPLICATE_IDENT,
   ERR_TYPE_INCONSISTENCY,
-  ERR_PARAMETERS_ARGUMENTS_INCONSISTENCY
+  ERR_PARAMETERS_ARGUMENTS_INCONSISTENCY,
+  ERR_DIVISION_BY_ZERO,
+  ERR_CONSTANT_OVERFLOW,
+  ERR_INVALID_ARRAY_SIZE,
+  ERR_FRAME_TOO_LARGE
 } ErrorCode;
 
+// Where error() and missingToken() jump after recording a diagnostic.
+// The parser points it at its innermost recovery point; when it is NULL,
+// the diagnostics are printed and the compiler exits as soon as one occurs.
+extern _Thread_local jmp_buf *recoveryPoint;
+
+// When set, the first error jumps there at once without being recorded,
+// overriding recoveryPoint
+extern _Thread_local jmp_buf *abortPoint;
+
+// When set, an error the parser cannot recover from jumps there instead
+// of printing the diagnostics and exiting
+extern _Thread_local jmp_buf *stopPoint;
+
+void recover(void);
 void error(ErrorCode err, int lineNo, int colNo);
 void missingToken(TokenType tokenType, int lineNo, int colNo);
+void reportError(ErrorCode err, int lineNo, int colNo);
+int errorCount(void);
+void clearErrors(void);
+void printErrors(void);
 void assert(char *msg);
 
 #endif
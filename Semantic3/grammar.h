@@ -0,0 +1,23 @@
+/* 
+ * @copyright (c) 2026
+ * @author agent <agent@local>
+ * @version 1.0
+ */
+
+#ifndef __GRAMMAR_H__
+#define __GRAMMAR_H__
+
+#include "token.h"
+
+// A set of token types, one bit per TokenType (there are fewer than 64)
+typedef unsigned long long TokenSet;
+
+#define TOKEN_BIT(tokenType) (1ULL << (tokenType))
+#define IN_SET(set, tokenType) (((set) & TOKEN_BIT(tokenType)) != 0)
+
+// FIRST and FOLLOW of each nonterminal of kpl.grammar, indexed by the
+// NT_ names of lltable.h. llgen generates both into lltable.c.
+extern const TokenSet firstSets[];
+extern const TokenSet followSets[];
+
+#endif
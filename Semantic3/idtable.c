@@ -0,0 +1,173 @@
+/*
+ * @copyright (c) 2026
+ * @author agent <agent@local>
+ * @version 1.0
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "idtable.h"
+
+extern _Thread_local SymTab* symtab;
+
+#define INITIAL_TABLE_SIZE 64
+
+// An identifier's name is that of the first object bound to it: objects
+// outlive the table, which cleanSymTab() frees before the symbol arena and
+// parseBody() before its block's arena is released
+struct Identifier {
+  char *name;
+  unsigned hash;
+  int top;                      // its innermost binding, -1 for none
+};
+
+struct Binding {
+  int ident;
+  Object* object;
+  int shadowed;                 // the binding it hides, -1 for none
+};
+
+// The scopes entered, with the first binding made in each
+struct ScopeMark {
+  Scope* scope;
+  int firstBinding;
+};
+
+// Identifiers keep their index for good; the hash table holds indexes
+_Thread_local struct Identifier* identifiers = NULL;
+_Thread_local int identCount = 0;
+_Thread_local int identCapacity = 0;
+
+_Thread_local int* identSlots = NULL;   // -1 for a free slot
+_Thread_local int slotCount = 0;        // a power of two
+
+_Thread_local struct Binding* bindings = NULL;
+_Thread_local int bindingTop = 0;
+_Thread_local int bindingCapacity = 0;
+
+_Thread_local struct ScopeMark* scopeMarks = NULL;
+_Thread_local int scopeTop = 0;
+_Thread_local int scopeCapacity = 0;
+
+void initIdentTable(void) {
+  slotCount = INITIAL_TABLE_SIZE;
+  identSlots = (int*) malloc(slotCount * sizeof(int));
+  memset(identSlots, -1, slotCount * sizeof(int));
+  identCount = bindingTop = scopeTop = 0;
+}
+
+void freeIdentTable(void) {
+  free(identifiers);
+  free(identSlots);
+  free(bindings);
+  free(scopeMarks);
+  identifiers = NULL;
+  identSlots = NULL;
+  bindings = NULL;
+  scopeMarks = NULL;
+  identCount = identCapacity = slotCount = 0;
+  bindingTop = bindingCapacity = 0;
+  scopeTop = scopeCapacity = 0;
+}
+
+/******************* Identifiers ******************************/
+
+// The slot holding name, or the free slot where it would go
+int findSlot(char *name, unsigned hash) {
+  int i = hash & (slotCount - 1);
+  int k;
+
+  while ((k = identSlots[i]) >= 0) {
+    if ((identifiers[k].hash == hash) && (strcmp(identifiers[k].name, name) == 0))
+      break;
+    i = (i + 1) & (slotCount - 1);
+  }
+  return i;
+}
+
+void growSlots(void) {
+  int k;
+
+  free(identSlots);
+  slotCount *= 2;
+  identSlots = (int*) malloc(slotCount * sizeof(int));
+  memset(identSlots, -1, slotCount * sizeof(int));
+  for (k = 0; k < identCount; k++)
+    identSlots[findSlot(identifiers[k].name, identifiers[k].hash)] = k;
+}
+
+int internIdent(Object* obj, unsigned hash) {
+  int i = findSlot(obj->name, hash);
+
+  if (identSlots[i] >= 0) return identSlots[i];
+
+  if (identCount == identCapacity) {
+    identCapacity = (identCapacity == 0) ? INITIAL_TABLE_SIZE : 2 * identCapacity;
+    identifiers = (struct Identifier*) realloc(identifiers, identCapacity * sizeof(struct Identifier));
+  }
+  identifiers[identCount].name = obj->name;
+  identifiers[identCount].hash = hash;
+  identifiers[identCount].top = -1;
+  identSlots[i] = identCount++;
+  if (2 * identCount > slotCount) growSlots();
+  return identCount - 1;
+}
+
+/******************* Bindings ******************************/
+
+void bindObject(ObjectNode* node) {
+  int k;
+
+  if (scopeTop == 0) return;
+  k = internIdent(node->object, node->hash);
+
+  if (bindingTop == bindingCapacity) {
+    bindingCapacity = (bindingCapacity == 0) ? INITIAL_TABLE_SIZE : 2 * bindingCapacity;
+    bindings = (struct Binding*) realloc(bindings, bindingCapacity * sizeof(struct Binding));
+  }
+  bindings[bindingTop].ident = k;
+  bindings[bindingTop].object = node->object;
+  bindings[bindingTop].shadowed = identifiers[k].top;
+  identifiers[k].top = bindingTop++;
+}
+
+void openScope(Scope* scope) {
+  ObjectNode* node;
+
+  if (scopeTop == scopeCapacity) {
+    scopeCapacity = (scopeCapacity == 0) ? INITIAL_TABLE_SIZE : 2 * scopeCapacity;
+    scopeMarks = (struct ScopeMark*) realloc(scopeMarks, scopeCapacity * sizeof(struct ScopeMark));
+  }
+  scopeMarks[scopeTop].scope = scope;
+  scopeMarks[scopeTop].firstBinding = bindingTop;
+  scopeTop ++;
+
+  for (node = scope->objList; node != NULL; node = node->next)
+    bindObject(node);
+}
+
+void closeScope(void) {
+  int first;
+
+  if (scopeTop == 0) return;
+  first = scopeMarks[--scopeTop].firstBinding;
+  while (bindingTop > first) {
+    bindingTop --;
+    identifiers[bindings[bindingTop].ident].top = bindings[bindingTop].shadowed;
+  }
+}
+
+Object* findIdent(char *name, unsigned hash) {
+  int k;
+
+  if (scopeTop == 0) return NULL;
+  k = identSlots[findSlot(name, hash)];
+  if ((k < 0) || (identifiers[k].top < 0)) return NULL;
+  return bindings[identifiers[k].top].object;
+}
+
+Scope* outsideScope(void) {
+  if (scopeTop == 0) return symtab->currentScope;
+  return scopeMarks[0].scope->outer;
+}
@@ -0,0 +1,37 @@
+/*
+ * @copyright (c) 2026
+ * @author agent <agent@local>
+ * @version 1.0
+ */
+
+#ifndef __IDTABLE_H__
+#define __IDTABLE_H__
+
+#include "symtab.h"
+
+// One table of the identifiers visible on this thread, after LeBlanc and
+// Cook: each name maps to the stack of its declarations in the open
+// scopes, the innermost on top. Entering a scope binds the objects it
+// already holds; leaving it pops every binding made since, so a lookup
+// is one probe however deep the scopes nest.
+//
+// Only the scopes entered on this thread are in the table. Those around
+// the outermost of them (the program scope, for a body parsed on its own
+// thread) are searched scope by scope.
+
+void initIdentTable(void);
+void freeIdentTable(void);
+
+void openScope(Scope* scope);
+void closeScope(void);
+// Bind the object of a node just added to the current scope
+void bindObject(ObjectNode* node);
+
+// The innermost visible object called name, or NULL if none of the
+// entered scopes declares it
+Object* findIdent(char *name, unsigned hash);
+
+// The scope around the outermost one entered, where lookups go on
+Scope* outsideScope(void);
+
+#endif
@@ -0,0 +1,476 @@
+/*
+ * @copyright (c) 2026
+ * @author agent <agent@local>
+ * @version 1.0
+ */
+
+// llgen: builds the LL(1) parse table of a grammar file (see kpl.grammar)
+// and writes it as C source for llparser.c, with the FIRST and FOLLOW sets
+// parser.c checks lookaheads against
+//
+//   llgen kpl.grammar > lltable.c
+//   llgen -h kpl.grammar > lltable.h     the NT_ names of the nonterminals
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#define MAX_SYMBOLS 256
+#define MAX_PRODUCTIONS 256
+#define MAX_RHS 16
+#define MAX_LINE 1024
+
+enum SymbolKind {
+  SYM_TERMINAL,
+  SYM_NONTERMINAL,
+  SYM_ACTION
+};
+
+struct Symbol {
+  char *name;
+  enum SymbolKind kind;
+  int index;                    // among the symbols of its kind
+};
+
+struct Production {
+  int lhs;                      // nonterminal index
+  int rhs[MAX_RHS];             // symbol numbers
+  int length;
+  int line;
+};
+
+struct Symbol symbols[MAX_SYMBOLS];
+int symbolCount = 0;
+int terminals[64], terminalCount = 0;
+int nonterminals[MAX_SYMBOLS], nonterminalCount = 0;
+int actions[MAX_SYMBOLS], actionCount = 0;
+
+struct Production productions[MAX_PRODUCTIONS];
+int productionCount = 0;
+
+char *errorCodes[MAX_SYMBOLS];
+int defined[MAX_SYMBOLS];
+int expectedConflicts = 0;
+
+// Sets of terminals, one bit per terminal index
+typedef unsigned long long TerminalSet;
+
+TerminalSet first[MAX_SYMBOLS];
+TerminalSet follow[MAX_SYMBOLS];
+int nullable[MAX_SYMBOLS];
+int table[MAX_SYMBOLS][64];     // production number + 1, or 0
+
+char *fileName;
+int lineNo = 0;
+int reportConflicts = 0;
+
+void fail(char *message, char *name) {
+  fprintf(stderr, "%s:%d: %s%s\n", fileName, lineNo, message, name);
+  exit(1);
+}
+
+/******************* Reading the grammar ******************************/
+
+int isTerminal(char *name) {
+  return (strncmp(name, "KW_", 3) == 0) || (strncmp(name, "TK_", 3) == 0) ||
+    (strncmp(name, "SB_", 3) == 0);
+}
+
+int findSymbol(char *name) {
+  int i;
+
+  for (i = 0; i < symbolCount; i++)
+    if (strcmp(symbols[i].name, name) == 0)
+      return i;
+
+  if (symbolCount == MAX_SYMBOLS) fail("too many symbols", "");
+  symbols[i].name = strdup(name);
+  if (name[0] == '@') {
+    symbols[i].kind = SYM_ACTION;
+    symbols[i].index = actionCount;
+    actions[actionCount++] = i;
+  } else if (isTerminal(name)) {
+    if (terminalCount == 64) fail("too many terminals", "");
+    symbols[i].kind = SYM_TERMINAL;
+    symbols[i].index = terminalCount;
+    terminals[terminalCount++] = i;
+  } else {
+    symbols[i].kind = SYM_NONTERMINAL;
+    symbols[i].index = nonterminalCount;
+    nonterminals[nonterminalCount++] = i;
+  }
+  symbolCount ++;
+  return i;
+}
+
+struct Production* startProduction(int lhs) {
+  struct Production* p;
+
+  if (productionCount == MAX_PRODUCTIONS) fail("too many productions", "");
+  p = &productions[productionCount++];
+  p->lhs = symbols[lhs].index;
+  p->length = 0;
+  p->line = lineNo;
+  defined[p->lhs] = 1;
+  return p;
+}
+
+void readGrammar(FILE* f) {
+  char line[MAX_LINE];
+  char *words[MAX_LINE / 2];
+  struct Production* current = NULL;
+  int lhs = -1;
+  int count, i;
+  char *s;
+
+  while (fgets(line, MAX_LINE, f) != NULL) {
+    lineNo ++;
+    if ((s = strchr(line, '#')) != NULL) *s = '\0';
+
+    count = 0;
+    for (s = strtok(line, " \t\r\n"); s != NULL; s = strtok(NULL, " \t\r\n"))
+      words[count++] = s;
+    if (count == 0) continue;
+
+    if (strcmp(words[0], "%expect") == 0) {
+      if (count != 2) fail("usage: %expect N", "");
+      expectedConflicts = atoi(words[1]);
+      continue;
+    }
+    if (strcmp(words[0], "%error") == 0) {
+      if (count != 3) fail("usage: %error Nonterminal CODE", "");
+      i = findSymbol(words[1]);
+      if (symbols[i].kind != SYM_NONTERMINAL) fail("not a nonterminal: ", words[1]);
+      errorCodes[symbols[i].index] = strdup(words[2]);
+      continue;
+    }
+
+    i = 0;
+    if ((count >= 2) && (strcmp(words[1], "->") == 0)) {
+      lhs = findSymbol(words[0]);
+      if (symbols[lhs].kind != SYM_NONTERMINAL) fail("not a nonterminal: ", words[0]);
+      current = startProduction(lhs);
+      i = 2;
+    } else if (strcmp(words[0], "|") == 0) {
+      if (lhs < 0) fail("alternative without a rule", "");
+      current = startProduction(lhs);
+      i = 1;
+    } else if (current == NULL) fail("rule expected", "");
+
+    // Anything else continues the current alternative
+    for (; i < count; i++) {
+      if (strcmp(words[i], "%empty") == 0) continue;
+      if (current->length == MAX_RHS) fail("alternative too long", "");
+      current->rhs[current->length++] = findSymbol(words[i]);
+    }
+  }
+
+  if (productionCount == 0) fail("no rules", "");
+  for (i = 0; i < nonterminalCount; i++)
+    if (!defined[i]) fail("no rule for ", symbols[nonterminals[i]].name);
+}
+
+/******************* LL(1) analysis ******************************/
+
+// FIRST of rhs[from..] into *set; returns whether that suffix is nullable
+int firstOfSequence(struct Production* p, int from, TerminalSet* set) {
+  int i;
+
+  for (i = from; i < p->length; i++) {
+    struct Symbol* sym = &symbols[p->rhs[i]];
+
+    switch (sym->kind) {
+    case SYM_ACTION:
+      break;
+    case SYM_TERMINAL:
+      *set |= 1ULL << sym->index;
+      return 0;
+    case SYM_NONTERMINAL:
+      *set |= first[sym->index];
+      if (!nullable[sym->index]) return 0;
+      break;
+    }
+  }
+  return 1;
+}
+
+void computeSets(void) {
+  int changed;
+  int p, i;
+
+  do {
+    changed = 0;
+    for (p = 0; p < productionCount; p++) {
+      TerminalSet set = 0;
+      int lhs = productions[p].lhs;
+
+      if (firstOfSequence(&productions[p], 0, &set) && !nullable[lhs]) {
+	nullable[lhs] = 1;
+	changed = 1;
+      }
+      if ((first[lhs] | set) != first[lhs]) {
+	first[lhs] |= set;
+	changed = 1;
+      }
+    }
+  } while (changed);
+
+  // The start symbol is followed by the end of the input
+  follow[productions[0].lhs] = 1ULL << symbols[findSymbol("TK_EOF")].index;
+  do {
+    changed = 0;
+    for (p = 0; p < productionCount; p++) {
+      struct Production* prod = &productions[p];
+
+      for (i = 0; i < prod->length; i++) {
+	struct Symbol* sym = &symbols[prod->rhs[i]];
+	TerminalSet set = 0;
+
+	if (sym->kind != SYM_NONTERMINAL) continue;
+	if (firstOfSequence(prod, i + 1, &set))
+	  set |= follow[prod->lhs];
+	if ((follow[sym->index] | set) != follow[sym->index]) {
+	  follow[sym->index] |= set;
+	  changed = 1;
+	}
+      }
+    }
+  } while (changed);
+}
+
+int fillCell(int nt, int t, int p) {
+  if (table[nt][t] == 0) {
+    table[nt][t] = p + 1;
+    return 0;
+  }
+  if (table[nt][t] == p + 1) return 0;
+  if (reportConflicts) fprintf(stderr, "%s:%d: conflict on %s with the alternative of line %d\n",
+	  fileName, productions[p].line, symbols[terminals[t]].name,
+	  productions[table[nt][t] - 1].line);
+  return 1;
+}
+
+int buildTable(void) {
+  int conflicts = 0;
+  int p, t, nt;
+
+  for (p = 0; p < productionCount; p++) {
+    TerminalSet set = 0;
+    int lhs = productions[p].lhs;
+
+    if (firstOfSequence(&productions[p], 0, &set))
+      set |= follow[lhs];
+    for (t = 0; t < terminalCount; t++)
+      if (set & (1ULL << t))
+	conflicts += fillCell(lhs, t, p);
+  }
+
+  // Without an error code of its own, a nullable nonterminal is taken as
+  // empty on any other token
+  for (nt = 0; nt < nonterminalCount; nt++) {
+    if (!nullable[nt] || (errorCodes[nt] != NULL)) continue;
+    for (p = 0; p < productionCount; p++) {
+      TerminalSet set = 0;
+      if ((productions[p].lhs == nt) && firstOfSequence(&productions[p], 0, &set))
+	break;
+    }
+    for (t = 0; t < terminalCount; t++)
+      if (table[nt][t] == 0) table[nt][t] = p + 1;
+  }
+  return conflicts;
+}
+
+/******************* Writing the tables ******************************/
+
+void printSymbol(struct Symbol* sym) {
+  switch (sym->kind) {
+  case SYM_TERMINAL:
+    printf("%s", sym->name);
+    break;
+  case SYM_NONTERMINAL:
+    printf("LL_NONTERMINAL + %d", sym->index);
+    break;
+  case SYM_ACTION:
+    printf("LL_ACTION + %d", sym->index);
+    break;
+  }
+}
+
+void printActionName(struct Symbol* sym) {
+  printf("act%c%s", toupper(sym->name[1]), sym->name + 2);
+}
+
+// A set of terminals as an expression of TokenSet (see grammar.h)
+void printSet(TerminalSet set) {
+  int t, first = 1;
+
+  for (t = 0; t < terminalCount; t++) {
+    if (!(set & (1ULL << t))) continue;
+    printf("%sTOKEN_BIT(%s)", first ? "" : " | ", symbols[terminals[t]].name);
+    first = 0;
+  }
+  if (first) printf("0");
+}
+
+// NT_ and the name of a nonterminal in capitals, with '_' between words
+void printEnumName(struct Symbol* sym) {
+  char *s;
+
+  printf("NT_");
+  for (s = sym->name; *s != '\0'; s++) {
+    if ((s != sym->name) && isupper(*s)) putchar('_');
+    putchar(toupper(*s));
+  }
+}
+
+void writeHeader(void) {
+  int i;
+
+  printf("/* Generated by llgen from %s: do not edit */\n\n", fileName);
+  printf("#ifndef __LLTABLE_H__\n#define __LLTABLE_H__\n\n");
+  printf("// Nonterminals, in the order of llNames\n");
+  printf("enum NonTerminal {\n");
+  for (i = 0; i < nonterminalCount; i++) {
+    printf("  ");
+    printEnumName(&symbols[nonterminals[i]]);
+    printf(",\n");
+  }
+  printf("  NT_COUNT\n};\n\n#endif\n");
+}
+
+void writeTables(void) {
+  int i, p, t, start;
+
+  printf("/* Generated by llgen from %s: do not edit */\n\n", fileName);
+  printf("#include \"llparser.h\"\n");
+  printf("#include \"grammar.h\"\n\n");
+
+  for (i = 0; i < actionCount; i++) {
+    printf("void ");
+    printActionName(&symbols[actions[i]]);
+    printf("(void);\n");
+  }
+
+  printf("\nconst char* const llNames[] = {\n");
+  for (i = 0; i < nonterminalCount; i++)
+    printf("  \"%s\",\n", symbols[nonterminals[i]].name);
+  printf("};\n");
+
+  printf("\nconst short llStart = LL_NONTERMINAL + %d;\n", productions[0].lhs);
+
+  // Right-hand sides are stored reversed, ready to be pushed
+  printf("\nconst short llSymbols[] = {\n");
+  for (p = 0; p < productionCount; p++) {
+    printf("  ");
+    for (i = productions[p].length - 1; i >= 0; i--) {
+      printSymbol(&symbols[productions[p].rhs[i]]);
+      printf(", ");
+    }
+    printf("/* %s */\n", symbols[nonterminals[productions[p].lhs]].name);
+  }
+  printf("  0\n};\n");
+
+  printf("\nconst struct LLProduction llProductions[] = {\n");
+  start = 0;
+  for (p = 0; p < productionCount; p++) {
+    printf("  {%d, %d},\n", start, productions[p].length);
+    start += productions[p].length;
+  }
+  printf("};\n");
+
+  printf("\nconst short llTable[][LL_COLUMNS] = {\n");
+  for (i = 0; i < nonterminalCount; i++) {
+    int comma = 0;
+    printf("  /* %s */ {", symbols[nonterminals[i]].name);
+    for (t = 0; t < terminalCount; t++) {
+      if (table[i][t] == 0) continue;
+      printf("%s[%s] = %d", comma ? ", " : "", symbols[terminals[t]].name, table[i][t]);
+      comma = 1;
+    }
+    printf("%s},\n", comma ? "" : "0");
+  }
+  printf("};\n");
+
+  // What to report when the lookahead selects no alternative: an error
+  // code, or the one terminal every alternative starts with
+  printf("\nconst int llExpected[] = {\n");
+  for (i = 0; i < nonterminalCount; i++) {
+    if ((errorCodes[i] != NULL) && isTerminal(errorCodes[i]))
+      printf("  %s,\n", errorCodes[i]);
+    else if ((errorCodes[i] == NULL) && (first[i] != 0) && ((first[i] & (first[i] - 1)) == 0)) {
+      for (t = 0; !(first[i] & (1ULL << t)); t++) ;
+      printf("  %s,\n", symbols[terminals[t]].name);
+    } else printf("  -1,\n");
+  }
+  printf("};\n");
+
+  printf("\nconst ErrorCode llErrors[] = {\n");
+  for (i = 0; i < nonterminalCount; i++)
+    printf("  %s,\n", ((errorCodes[i] != NULL) && !isTerminal(errorCodes[i])) ?
+	   errorCodes[i] : "ERR_INVALID_SYMBOL");
+  printf("};\n");
+
+  printf("\nconst TokenSet firstSets[] = {\n");
+  for (i = 0; i < nonterminalCount; i++) {
+    printf("  /* %s */ ", symbols[nonterminals[i]].name);
+    printSet(first[i]);
+    printf(",\n");
+  }
+  printf("};\n");
+
+  printf("\nconst TokenSet followSets[] = {\n");
+  for (i = 0; i < nonterminalCount; i++) {
+    printf("  /* %s */ ", symbols[nonterminals[i]].name);
+    printSet(follow[i]);
+    printf(",\n");
+  }
+  printf("};\n");
+
+  printf("\nvoid (*const llActions[])(void) = {\n");
+  for (i = 0; i < actionCount; i++) {
+    printf("  ");
+    printActionName(&symbols[actions[i]]);
+    printf(",\n");
+  }
+  printf("};\n");
+}
+
+/******************************************************************/
+
+int main(int argc, char *argv[]) {
+  FILE* f;
+  int conflicts;
+  int header = 0;
+
+  if ((argc == 3) && (strcmp(argv[1], "-h") == 0)) {
+    header = 1;
+    argv++;
+    argc--;
+  }
+  if (argc != 2) {
+    fprintf(stderr, "usage: llgen [-h] grammar\n");
+    return 1;
+  }
+  fileName = argv[1];
+  if ((f = fopen(fileName, "r")) == NULL) {
+    fprintf(stderr, "llgen: can\'t read %s\n", fileName);
+    return 1;
+  }
+  readGrammar(f);
+  fclose(f);
+
+  computeSets();
+  conflicts = buildTable();
+  if (conflicts != expectedConflicts) {
+    memset(table, 0, sizeof(table));
+    reportConflicts = 1;
+    buildTable();
+    fprintf(stderr, "%s: %d conflicts, %d expected\n", fileName, conflicts, expectedConflicts);
+    return 1;
+  }
+
+  if (header) writeHeader();
+  else writeTables();
+  return 0;
+}
@@ -0,0 +1,561 @@
+/*
+ * @copyright (c) 2026
+ * @author agent <agent@local>
+ * @version 1.0
+ */
+
+#include <stdlib.h>
+
+#include "parser.h"
+#include "llparser.h"
+#include "stackparser.h"
+#include "semantics.h"
+#include "error.h"
+#include "trace.h"
+
+extern _Thread_local Token *currentToken;
+extern _Thread_local Token *lookAhead;
+extern _Thread_local SymTab* symtab;
+
+int tableParse = 0;
+
+#define INITIAL_STACK_SIZE 64
+
+/******************* Stacks ******************************/
+
+// Grammar symbols still to be matched, the next one on top
+short* symbolStack = NULL;
+int symbolTop = 0;
+int symbolStackSize = 0;
+
+// What the actions have built so far and not yet handed to the object
+// or node it belongs to
+union LLValue {
+  Object* obj;
+  Node* node;
+  NodeList** tail;      // where the next node of a list goes
+  Type* type;
+  ConstantValue* constant;
+  int number;
+};
+
+union LLValue* valueStack = NULL;
+int valueTop = 0;
+int valueStackSize = 0;
+
+void pushSymbol(short symbol) {
+  if (symbolTop == symbolStackSize) {
+    symbolStackSize = (symbolStackSize == 0) ? INITIAL_STACK_SIZE : 2 * symbolStackSize;
+    symbolStack = (short*) realloc(symbolStack, symbolStackSize * sizeof(short));
+  }
+  symbolStack[symbolTop++] = symbol;
+}
+
+union LLValue* pushValue(void) {
+  if (valueTop == valueStackSize) {
+    valueStackSize = (valueStackSize == 0) ? INITIAL_STACK_SIZE : 2 * valueStackSize;
+    valueStack = (union LLValue*) realloc(valueStack, valueStackSize * sizeof(union LLValue));
+  }
+  return &valueStack[valueTop++];
+}
+
+#define TOP (valueStack[valueTop - 1])
+#define POP (valueStack[--valueTop])
+
+void freeLLStacks(void) {
+  free(symbolStack);
+  free(valueStack);
+  symbolStack = NULL;
+  valueStack = NULL;
+  symbolStackSize = valueStackSize = 0;
+  symbolTop = valueTop = 0;
+}
+
+/******************* Driver ******************************/
+
+void compileProgramLL(void) {
+  const struct LLProduction* production;
+  short symbol;
+  int p, i;
+
+  TRACE_RULE();
+  symbolTop = valueTop = 0;
+  pushSymbol(llStart);
+
+  while (symbolTop > 0) {
+    symbol = symbolStack[--symbolTop];
+
+    if (symbol < LL_NONTERMINAL)
+      eat(symbol);
+    else if (symbol >= LL_ACTION)
+      llActions[symbol - LL_ACTION]();
+    else {
+      p = llTable[symbol - LL_NONTERMINAL][lookAhead->tokenType];
+      if (p == 0) {
+	if (llExpected[symbol - LL_NONTERMINAL] >= 0)
+	  missingToken(llExpected[symbol - LL_NONTERMINAL], lookAhead->lineNo, lookAhead->colNo);
+	else error(llErrors[symbol - LL_NONTERMINAL], lookAhead->lineNo, lookAhead->colNo);
+      }
+      production = &llProductions[p - 1];
+      for (i = 0; i < production->length; i++)
+	pushSymbol(llSymbols[production->start + i]);
+    }
+  }
+}
+
+/******************* Declarations ******************************/
+
+void actProgram(void) {
+  Object* program = createProgramObject(currentToken->string);
+
+  enterBlock(program->progAttrs.scope);
+  pushValue()->obj = program;
+}
+
+void actEndProgram(void) {
+  Node* body = POP.node;
+  Object* program = POP.obj;
+
+  program->progAttrs.body = body;
+  exitBlock();
+}
+
+void actConstant(void) {
+  checkFreshIdent(currentToken->string);
+  pushValue()->obj = createConstantObject(currentToken->string);
+}
+
+void actDeclareConstant(void) {
+  ConstantValue* value = POP.constant;
+  Object* constObj = POP.obj;
+
+  constObj->constAttrs.value = value;
+  declareObject(constObj);
+}
+
+void actType(void) {
+  checkFreshIdent(currentToken->string);
+  pushValue()->obj = createTypeObject(currentToken->string);
+}
+
+void actDeclareType(void) {
+  Type* actualType = POP.type;
+  Object* typeObj = POP.obj;
+
+  typeObj->typeAttrs.actualType = actualType;
+  declareObject(typeObj);
+}
+
+void actVariable(void) {
+  checkFreshIdent(currentToken->string);
+  pushValue()->obj = createVariableObject(currentToken->string);
+}
+
+void actDeclareVariable(void) {
+  Type* varType = POP.type;
+  Object* varObj = POP.obj;
+
+  varObj->varAttrs.type = varType;
+  checkFrameSpace(varType);
+  declareObject(varObj);
+}
+
+void actFunction(void) {
+  Object* funcObj;
+
+  checkFreshIdent(currentToken->string);
+  funcObj = createFunctionObject(currentToken->string);
+  declareObject(funcObj);
+  enterBlock(funcObj->funcAttrs.scope);
+  pushValue()->obj = funcObj;
+}
+
+void actReturnType(void) {
+  Type* returnType = POP.type;
+
+  TOP.obj->funcAttrs.returnType = returnType;
+}
+
+void actProcedure(void) {
+  Object* procObj;
+
+  checkFreshIdent(currentToken->string);
+  procObj = createProcedureObject(currentToken->string);
+  declareObject(procObj);
+  enterBlock(procObj->procAttrs.scope);
+  pushValue()->obj = procObj;
+}
+
+// With -i, pass over the tokens of the block or statements that come next
+// as compileBlock5() and compileFuncDecl() do, and stand in for their
+// symbol with a missing body
+void actSkipBlock(void) {
+  if (!skipBodies) return;
+  skipBlock();
+  symbolTop --;
+  pushValue()->node = NULL;
+}
+
+// The block of a function or procedure and the ';' after it are done
+void actBody(void) {
+  Node* body = POP.node;
+  Object* owner = POP.obj;
+
+  setBody(owner, body);
+  exitBlock();
+}
+
+void actValueParam(void) {
+  checkFreshIdent(currentToken->string);
+  pushValue()->obj = createParameterObject(currentToken->string, PARAM_VALUE, symtab->currentScope->owner);
+}
+
+void actReferenceParam(void) {
+  checkFreshIdent(currentToken->string);
+  pushValue()->obj = createParameterObject(currentToken->string, PARAM_REFERENCE, symtab->currentScope->owner);
+}
+
+void actDeclareParam(void) {
+  Type* type = POP.type;
+  Object* param = POP.obj;
+
+  param->paramAttrs.type = type;
+  declareObject(param);
+}
+
+void actIntType(void) {
+  pushValue()->type = makeIntType();
+}
+
+void actCharType(void) {
+  pushValue()->type = makeCharType();
+}
+
+void actArraySize(void) {
+  int size = checkArraySize(TOP.constant);
+
+  TOP.number = size;
+}
+
+void actArrayType(void) {
+  Type* elementType = POP.type;
+  int arraySize = POP.number;
+
+  checkArrayWords(arraySize, elementType);
+  pushValue()->type = makeArrayType(arraySize, elementType);
+}
+
+void actNamedType(void) {
+  Object* obj = checkDeclaredType(currentToken->string);
+
+  pushValue()->type = obj->typeAttrs.actualType;
+}
+
+void actPositive(void) {
+  checkIntConstant(TOP.constant);
+}
+
+void actNegate(void) {
+  negateConstant(TOP.constant);
+}
+
+// The operator just eaten, kept until its right operand is complete
+void actConstantOperator(void) {
+  pushValue()->number = currentToken->tokenType;
+}
+
+void actFoldConstant(void) {
+  ConstantValue* right = POP.constant;
+  TokenType op = POP.number;
+
+  foldConstant(op, TOP.constant, right);
+}
+
+void actCharConstant(void) {
+  pushValue()->constant = makeCharConstant(currentToken->string[0]);
+}
+
+void actNumberConstant(void) {
+  pushValue()->constant = makeIntConstant(currentToken->value);
+}
+
+void actNamedConstant(void) {
+  Object* obj = checkDeclaredConstant(currentToken->string);
+
+  pushValue()->constant = duplicateConstantValue(obj->constAttrs.value);
+}
+
+/******************* Statements ******************************/
+
+// Node of the token just eaten
+Node* makeCurrentNode(enum NodeKind kind) {
+  return makeNode(kind, currentToken->lineNo, currentToken->colNo);
+}
+
+// BEGIN has been eaten: the group and the tail of its statement list
+void actGroup(void) {
+  Node* group = makeCurrentNode(N_GROUP);
+
+  pushValue()->node = group;
+  pushValue()->tail = &group->group.stmts;
+}
+
+void actAppend(void) {
+  Node* node = POP.node;
+
+  TOP.tail = appendNode(TOP.tail, node);
+}
+
+void actEndList(void) {
+  valueTop --;
+}
+
+// An index of the variable below the list tail, appended to the list
+void actIndex(void) {
+  Node* index = POP.node;
+
+  checkIndex(valueStack[valueTop - 2].node, index);
+  TOP.tail = appendNode(TOP.tail, index);
+}
+
+void actEmptySt(void) {
+  pushValue()->node = makeNode(N_EMPTY, lookAhead->lineNo, lookAhead->colNo);
+}
+
+void actLvalue(void) {
+  Object* var = checkDeclaredLValueIdent(currentToken->string);
+  Node* lvalue;
+
+  pushValue()->node = makeCurrentNode(N_ASSIGN);
+  lvalue = makeCurrentNode(N_VARIABLE);
+  lvalue->var.obj = var;
+  lvalue->type = typeOfObject(var);
+  resolveAddress(var, &lvalue->var.addr);
+  pushValue()->node = lvalue;
+}
+
+// Only a variable takes indexes; the hand-written parser expects the ':='
+// after any other left-hand side
+void actLvalueIndexes(void) {
+  Node* lvalue = TOP.node;
+
+  if (lvalue->var.obj->kind != OBJ_VARIABLE)
+    missingToken(SB_ASSIGN, lookAhead->lineNo, lookAhead->colNo);
+  pushValue()->tail = &lvalue->var.indexes;
+}
+
+void actAssign(void) {
+  Node* expr = POP.node;
+  Node* lvalue = POP.node;
+
+  checkTypeEquality(lvalue->type, expr->type);
+  TOP.node->assign.lvalue = lvalue;
+  TOP.node->assign.expr = expr;
+}
+
+void actCall(void) {
+  pushValue()->node = makeCurrentNode(N_CALL);
+}
+
+void actCallee(void) {
+  TOP.node->call.obj = checkDeclaredProcedure(currentToken->string);
+}
+
+void actArguments(void) {
+  Node* call = TOP.node;
+
+  if ((call->kind != N_CALL) && (call->kind != N_FUNCTION_CALL))
+    error(ERR_INVALID_TERM, lookAhead->lineNo, lookAhead->colNo);
+  pushValue()->tail = &call->call.args;
+}
+
+void actEndCall(void) {
+  checkArguments(TOP.node);
+}
+
+void actIf(void) {
+  pushValue()->node = makeCurrentNode(N_IF);
+}
+
+void actIfCondition(void) {
+  Node* cond = POP.node;
+
+  TOP.node->ifSt.cond = cond;
+}
+
+void actThen(void) {
+  Node* stmt = POP.node;
+
+  TOP.node->ifSt.thenSt = stmt;
+}
+
+void actElse(void) {
+  Node* stmt = POP.node;
+
+  TOP.node->ifSt.elseSt = stmt;
+}
+
+void actWhile(void) {
+  pushValue()->node = makeCurrentNode(N_WHILE);
+}
+
+void actWhileCondition(void) {
+  Node* cond = POP.node;
+
+  TOP.node->whileSt.cond = cond;
+}
+
+void actWhileBody(void) {
+  Node* stmt = POP.node;
+
+  TOP.node->whileSt.body = stmt;
+}
+
+void actFor(void) {
+  pushValue()->node = makeCurrentNode(N_FOR);
+}
+
+void actForVariable(void) {
+  TOP.node->forSt.var = checkDeclaredVariable(currentToken->string);
+  resolveAddress(TOP.node->forSt.var, &TOP.node->forSt.addr);
+}
+
+void actForFrom(void) {
+  Node* expr = POP.node;
+
+  checkBasicType(TOP.node->forSt.var->varAttrs.type);
+  checkTypeEquality(TOP.node->forSt.var->varAttrs.type, expr->type);
+  TOP.node->forSt.from = expr;
+}
+
+void actForTo(void) {
+  Node* expr = POP.node;
+
+  checkTypeEquality(TOP.node->forSt.var->varAttrs.type, expr->type);
+  TOP.node->forSt.to = expr;
+}
+
+void actForBody(void) {
+  Node* stmt = POP.node;
+
+  TOP.node->forSt.body = stmt;
+}
+
+/******************* Expressions ******************************/
+
+void actCondition(void) {
+  pushValue()->node = makeNode(N_CONDITION, lookAhead->lineNo, lookAhead->colNo);
+}
+
+void actLeft(void) {
+  Node* left = POP.node;
+
+  TOP.node->binary.left = left;
+}
+
+void actComparator(void) {
+  TOP.node->binary.op = currentToken->tokenType;
+}
+
+void actRight(void) {
+  Node* right = POP.node;
+
+  if (TOP.node->kind == N_CONDITION) {
+    checkBasicType(TOP.node->binary.left->type);
+    checkTypeEquality(TOP.node->binary.left->type, right->type);
+  } else checkIntType(right->type);
+  TOP.node->binary.right = right;
+  if (TOP.node->kind == N_BINARY) foldBinary(TOP.node);
+}
+
+void actUnary(void) {
+  Node* expr = makeCurrentNode(N_UNARY);
+
+  expr->type = makeIntType();
+  expr->unary.op = SB_MINUS;
+  pushValue()->node = expr;
+}
+
+void actOperand(void) {
+  Node* operand = POP.node;
+
+  checkIntType(operand->type);
+  TOP.node->unary.operand = operand;
+  foldUnary(TOP.node);
+}
+
+// The operand of a unary plus, which stands for itself
+void actPlus(void) {
+  checkIntType(TOP.node->type);
+}
+
+// The operator just eaten takes the tree built so far as its left operand
+void actBinary(void) {
+  Node* expr = makeCurrentNode(N_BINARY);
+
+  checkIntType(TOP.node->type);
+  expr->type = makeIntType();
+  expr->binary.op = currentToken->tokenType;
+  expr->binary.left = TOP.node;
+  TOP.node = expr;
+}
+
+void actNumber(void) {
+  Node* factor = makeCurrentNode(N_NUMBER);
+
+  factor->value = currentToken->value;
+  factor->type = makeIntType();
+  pushValue()->node = factor;
+}
+
+void actChar(void) {
+  Node* factor = makeCurrentNode(N_CHAR);
+
+  factor->value = currentToken->string[0];
+  factor->type = makeCharType();
+  pushValue()->node = factor;
+}
+
+void actIdent(void) {
+  Object* obj = checkDeclaredIdent(currentToken->string);
+  Node* factor = NULL;
+
+  switch (obj->kind) {
+  case OBJ_CONSTANT:
+    factor = makeCurrentNode(N_CONSTANT);
+    factor->var.obj = obj;
+    break;
+  case OBJ_VARIABLE:
+  case OBJ_PARAMETER:
+    factor = makeCurrentNode(N_VARIABLE);
+    factor->var.obj = obj;
+    resolveAddress(obj, &factor->var.addr);
+    break;
+  case OBJ_FUNCTION:
+    factor = makeCurrentNode(N_FUNCTION_CALL);
+    factor->call.obj = obj;
+    break;
+  default:
+    error(ERR_INVALID_FACTOR, currentToken->lineNo, currentToken->colNo);
+    break;
+  }
+  factor->type = typeOfObject(obj);
+  pushValue()->node = factor;
+}
+
+// A function call is complete once its arguments, if any, are
+void actEndFactor(void) {
+  if (TOP.node->kind == N_FUNCTION_CALL)
+    checkArguments(TOP.node);
+}
+
+void actIndexes(void) {
+  Node* factor = TOP.node;
+
+  if ((factor->kind != N_VARIABLE) || (factor->var.obj->kind != OBJ_VARIABLE)) {
+    if (factor->kind == N_FUNCTION_CALL)
+      error(ERR_INVALID_ARGUMENTS, lookAhead->lineNo, lookAhead->colNo);
+    else error(ERR_INVALID_TERM, lookAhead->lineNo, lookAhead->colNo);
+  }
+  pushValue()->tail = &factor->var.indexes;
+}
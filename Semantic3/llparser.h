@@ -0,0 +1,45 @@
+/*
+ * @copyright (c) 2026
+ * @author agent <agent@local>
+ * @version 1.0
+ */
+
+#ifndef __LLPARSER_H__
+#define __LLPARSER_H__
+
+#include "token.h"
+#include "error.h"
+
+// Table-driven LL(1) parser. Its tables (lltable.c) are generated by llgen
+// from kpl.grammar.
+
+// Symbols of a right-hand side: a token type, LL_NONTERMINAL + the index
+// of a nonterminal, or LL_ACTION + the index of a semantic action
+#define LL_COLUMNS 64
+#define LL_NONTERMINAL 64
+#define LL_ACTION 256
+
+struct LLProduction {
+  short start;          // first symbol in llSymbols, pushed last
+  short length;
+};
+
+extern const short llStart;
+extern const char* const llNames[];
+extern const short llSymbols[];
+extern const struct LLProduction llProductions[];
+// Production number + 1 for each nonterminal and lookahead, 0 for an error
+extern const short llTable[][LL_COLUMNS];
+// The token reported missing on an error, or -1 to report llErrors instead
+extern const int llExpected[];
+extern const ErrorCode llErrors[];
+extern void (*const llActions[])(void);
+
+// When set, compile() parses with the tables instead of recursive descent.
+// The first error ends the compilation: there is no recovery.
+extern int tableParse;
+
+void compileProgramLL(void);
+void freeLLStacks(void);
+
+#endif
@@ -7,21 +7,112 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#include <string.h>
+#include <unistd.h>
+
 #include "reader.h"
 #include "parser.h"
+#include "tokenwin.h"
+#include "stackparser.h"
+#include "llparser.h"
+#include "parallel.h"
+#include "bodycache.h"
+#include "strpool.h"
+#include "trace.h"
+#include "debug.h"
+#include "module.h"
 
 /******************************************************************/
 
 int main(int argc, char *argv[]) {
-  if (argc <= 1) {
+  char line[256];
+  int i = 1;
+  int moduleInput = 0;
+  Module* module;
+
+  // Options:
+  //   -t  run the scanner on a separate thread
+  //   -a  print the syntax tree after the symbol table
+  //   -s  parse with explicit stacks instead of recursion
+  //   -g  parse with the LL(1) tables generated from kpl.grammar, stopping
+  //       at the first error
+  //   -pN parse the blocks of the program's functions and procedures on
+  //       N threads (-p alone: one per processor)
+  //   -w  compile again each time a line is read from the standard input,
+  //       reparsing only the functions and procedures that changed; each
+  //       compilation's output ends with a line holding a single "."
+  //   -i  compile the declarations only, skipping over statements
+  //   -m file  write the declarations of the program to file, as a
+  //       module that -l reads back
+  //   -l  the input file is a module: print its declarations without
+  //       compiling anything
+  //   -T file  write a trace of the grammar rules to file (builds with
+  //       make TRACE=1 only)
+  while ((i < argc) && (argv[i][0] == '-')) {
+    if (strcmp(argv[i], "-t") == 0)
+      threadedScan = 1;
+    else if (strcmp(argv[i], "-a") == 0)
+      printTree = 1;
+    else if (strcmp(argv[i], "-s") == 0)
+      stackParse = 1;
+    else if (strcmp(argv[i], "-g") == 0)
+      tableParse = 1;
+    else if (strcmp(argv[i], "-w") == 0)
+      incremental = 1;
+    else if (strcmp(argv[i], "-i") == 0)
+      skipBodies = 1;
+    else if ((strcmp(argv[i], "-m") == 0) && (i + 1 < argc))
+      moduleFile = argv[++i];
+    else if (strcmp(argv[i], "-l") == 0)
+      moduleInput = 1;
+#ifdef PARSE_TRACE
+    else if ((strcmp(argv[i], "-T") == 0) && (i + 1 < argc))
+      startTrace(argv[++i]);
+#endif
+    else if (strncmp(argv[i], "-p", 2) == 0) {
+      parallelThreads = atoi(argv[i] + 2);
+      if (parallelThreads <= 0)
+	parallelThreads = sysconf(_SC_NPROCESSORS_ONLN);
+    }
+    else {
+      printf("parser: unknown option %s\n", argv[i]);
+      return -1;
+    }
+    i ++;
+  }
+
+  if (i >= argc) {
     printf("parser: no input file.\n");
     return -1;
   }
 
-  if (compile(argv[1]) == IO_ERROR) {
-    printf("Can\'t read input file!\n");
-    return -1;
+  if (moduleInput) {
+    module = loadModule(argv[i]);
+    if (module == NULL) {
+      printf("Can\'t read module file: %s!\n", moduleError);
+      return -1;
+    }
+    printObject(module->program, 0);
+    freeModule(module);
+    return 0;
+  }
+
+  initStringPool();
+  initTypes();
+  while (1) {
+    if (compile(argv[i]) == IO_ERROR) {
+      printf("Can\'t read input file!\n");
+      return -1;
+    }
+    if (!incremental) break;
+
+    printf(".\n");
+    fflush(stdout);
+    if (fgets(line, sizeof(line), stdin) == NULL) break;
   }
+  freeBodyCache();
+  freeTypes();
+  freeStringPool();
     
   return 0;
 }
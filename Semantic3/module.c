@@ -0,0 +1,401 @@
+/*
+ * @copyright (c) 2026
+ * @author agent <agent@local>
+ * @version 1.0
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "module.h"
+#include "reader.h"
+
+#define INITIAL_IMAGE_SIZE 4096
+#define INITIAL_LIST_SIZE 256
+
+// Everything in the image starts at a multiple of this
+#define ALIGNMENT sizeof(void*)
+#define ALIGN(size) (((size) + ALIGNMENT - 1) & ~(ALIGNMENT - 1))
+
+char* moduleFile = NULL;
+char* moduleError = NULL;
+
+// The image begins with a header. Every pointer in the image holds the
+// offset of its target from the start of the image, NULL being 0, and the
+// offsets of all non-NULL pointers follow the image: loading adds the
+// address the image is mapped at to each of them.
+struct ModuleHeader {
+  char magic[4];
+  int version;
+  int pointerSize;
+  int objectSize;
+  int imageSize;                // the relocations start there
+  int relocationCount;
+  Object* program;
+};
+
+const char moduleMagic[4] = {'K', 'P', 'L', 'M'};
+
+/******************* Writing ******************************/
+
+enum ItemKind {
+  ITEM_STRING,
+  ITEM_TYPE,
+  ITEM_CONSTANT,
+  ITEM_OBJECT,
+  ITEM_NODE,
+  ITEM_SCOPE,
+  ITEM_TABLE
+};
+
+// A structure given room in the image, whose contents are copied once the
+// items before it are. Working through them in order rather than
+// following pointers recursively keeps deeply nested programs off the
+// C stack.
+struct Item {
+  enum ItemKind kind;
+  void* source;
+  int offset;
+  int size;
+};
+
+char* moduleImage = NULL;
+int moduleImageSize = 0;
+int moduleImageCapacity = 0;
+
+int* moduleRelocations = NULL;
+int moduleRelocationCount = 0;
+int moduleRelocationCapacity = 0;
+
+struct Item* moduleItems = NULL;
+int moduleItemCount = 0;
+int moduleItemCapacity = 0;
+
+// The offset each item was given, by its source address: an open
+// addressing table of at most half full slots
+struct Item** placements = NULL;
+int placementSize = 0;
+
+int reserveSpace(int size) {
+  int offset = moduleImageSize;
+
+  size = ALIGN(size);
+  while (moduleImageSize + size > moduleImageCapacity) {
+    moduleImageCapacity = (moduleImageCapacity == 0) ? INITIAL_IMAGE_SIZE : 2 * moduleImageCapacity;
+    moduleImage = (char*) realloc(moduleImage, moduleImageCapacity);
+  }
+  memset(moduleImage + offset, 0, size);
+  moduleImageSize += size;
+  return offset;
+}
+
+unsigned hashAddress(void* source) {
+  uintptr_t a = (uintptr_t) source;
+
+  return (unsigned) ((a >> 3) ^ (a >> 17));
+}
+
+// Make room for more items. The table is rebuilt, as its slots point into
+// moduleItems.
+void growItems(void) {
+  int i;
+  unsigned h;
+
+  moduleItemCapacity = (moduleItemCapacity == 0) ? INITIAL_LIST_SIZE : 2 * moduleItemCapacity;
+  moduleItems = (struct Item*) realloc(moduleItems, moduleItemCapacity * sizeof(struct Item));
+
+  free(placements);
+  placementSize = 2 * moduleItemCapacity;
+  placements = (struct Item**) calloc(placementSize, sizeof(struct Item*));
+  for (i = 0; i < moduleItemCount; i++) {
+    h = hashAddress(moduleItems[i].source) & (placementSize - 1);
+    while (placements[h] != NULL) h = (h + 1) & (placementSize - 1);
+    placements[h] = &moduleItems[i];
+  }
+}
+
+// The offset of source in the image, giving it room there the first time
+int place(void* source, enum ItemKind kind, int size) {
+  struct Item* item;
+  unsigned h;
+
+  if (source == NULL) return 0;
+
+  h = hashAddress(source) & (placementSize - 1);
+  while (placements[h] != NULL) {
+    if (placements[h]->source == source) return placements[h]->offset;
+    h = (h + 1) & (placementSize - 1);
+  }
+
+  if (moduleItemCount == moduleItemCapacity) {
+    growItems();
+    h = hashAddress(source) & (placementSize - 1);
+    while (placements[h] != NULL) h = (h + 1) & (placementSize - 1);
+  }
+  item = &moduleItems[moduleItemCount++];
+  item->kind = kind;
+  item->source = source;
+  item->size = size;
+  item->offset = reserveSpace(size);
+  placements[h] = item;
+  return item->offset;
+}
+
+// Store the offset target in the pointer at offset field
+void setPointer(int field, int target) {
+  *(uintptr_t*) (moduleImage + field) = (uintptr_t) target;
+  if (target == 0) return;
+
+  if (moduleRelocationCount == moduleRelocationCapacity) {
+    moduleRelocationCapacity = (moduleRelocationCapacity == 0) ? INITIAL_LIST_SIZE : 2 * moduleRelocationCapacity;
+    moduleRelocations = (int*) realloc(moduleRelocations, moduleRelocationCapacity * sizeof(int));
+  }
+  moduleRelocations[moduleRelocationCount++] = field;
+}
+
+int placeString(char* s) {
+  return place(s, ITEM_STRING, strlen(s) + 1);
+}
+
+int placeType(Type* type) {
+  return place(type, ITEM_TYPE, sizeof(Type));
+}
+
+int placeObject(Object* obj) {
+  return (obj == NULL) ? 0 : place(obj, ITEM_OBJECT, objectSize(obj));
+}
+
+int placeNode(ObjectNode* node) {
+  return place(node, ITEM_NODE, sizeof(ObjectNode));
+}
+
+int placeScope(Scope* scope) {
+  return place(scope, ITEM_SCOPE, sizeof(Scope));
+}
+
+#define FIELD(type, member) (item.offset + offsetof(type, member))
+
+void writeObject(struct Item item) {
+  Object* obj = (Object*) item.source;
+
+  if (obj->name == obj->inlineName)
+    setPointer(FIELD(Object, name), FIELD(Object, inlineName));
+  else setPointer(FIELD(Object, name), placeString(obj->name));
+
+  switch (obj->kind) {
+  case OBJ_CONSTANT:
+    setPointer(FIELD(Object, constAttrs.value),
+	       place(obj->constAttrs.value, ITEM_CONSTANT, sizeof(ConstantValue)));
+    break;
+  case OBJ_VARIABLE:
+    setPointer(FIELD(Object, varAttrs.type), placeType(obj->varAttrs.type));
+    setPointer(FIELD(Object, varAttrs.scope), placeScope(obj->varAttrs.scope));
+    break;
+  case OBJ_TYPE:
+    setPointer(FIELD(Object, typeAttrs.actualType), placeType(obj->typeAttrs.actualType));
+    break;
+  case OBJ_FUNCTION:
+    setPointer(FIELD(Object, funcAttrs.paramList), placeNode(obj->funcAttrs.paramList));
+    setPointer(FIELD(Object, funcAttrs.lastParam), placeNode(obj->funcAttrs.lastParam));
+    setPointer(FIELD(Object, funcAttrs.returnType), placeType(obj->funcAttrs.returnType));
+    setPointer(FIELD(Object, funcAttrs.scope), placeScope(obj->funcAttrs.scope));
+    setPointer(FIELD(Object, funcAttrs.body), 0);
+    break;
+  case OBJ_PROCEDURE:
+    setPointer(FIELD(Object, procAttrs.paramList), placeNode(obj->procAttrs.paramList));
+    setPointer(FIELD(Object, procAttrs.lastParam), placeNode(obj->procAttrs.lastParam));
+    setPointer(FIELD(Object, procAttrs.scope), placeScope(obj->procAttrs.scope));
+    setPointer(FIELD(Object, procAttrs.body), 0);
+    break;
+  case OBJ_PARAMETER:
+    setPointer(FIELD(Object, paramAttrs.type), placeType(obj->paramAttrs.type));
+    setPointer(FIELD(Object, paramAttrs.function), placeObject(obj->paramAttrs.function));
+    break;
+  case OBJ_PROGRAM:
+    setPointer(FIELD(Object, progAttrs.scope), placeScope(obj->progAttrs.scope));
+    setPointer(FIELD(Object, progAttrs.body), 0);
+    break;
+  }
+}
+
+// Copy an item into the room it was given, then turn its pointers into
+// offsets of the items they point to
+void writeItem(struct Item item) {
+  Type* type;
+  ObjectNode* node;
+  Scope* scope;
+  ObjectNode** table;
+  int i;
+
+  memcpy(moduleImage + item.offset, item.source, item.size);
+  switch (item.kind) {
+  case ITEM_STRING:
+  case ITEM_CONSTANT:
+    break;
+  case ITEM_TYPE:
+    type = (Type*) item.source;
+    if (type->typeClass == TP_ARRAY)
+      setPointer(FIELD(Type, elementType), placeType(type->elementType));
+    else setPointer(FIELD(Type, elementType), 0);
+    break;
+  case ITEM_OBJECT:
+    writeObject(item);
+    break;
+  case ITEM_NODE:
+    node = (ObjectNode*) item.source;
+    setPointer(FIELD(ObjectNode, object), placeObject(node->object));
+    setPointer(FIELD(ObjectNode, next), placeNode(node->next));
+    break;
+  case ITEM_SCOPE:
+    scope = (Scope*) item.source;
+    setPointer(FIELD(Scope, objList), placeNode(scope->objList));
+    setPointer(FIELD(Scope, lastObject), placeNode(scope->lastObject));
+    setPointer(FIELD(Scope, table),
+	       place(scope->table, ITEM_TABLE, scope->tableSize * sizeof(ObjectNode*)));
+    setPointer(FIELD(Scope, owner), placeObject(scope->owner));
+    setPointer(FIELD(Scope, outer), placeScope(scope->outer));
+    setPointer(FIELD(Scope, arena), 0);
+    break;
+  case ITEM_TABLE:
+    table = (ObjectNode**) item.source;
+    for (i = 0; i < item.size / (int) sizeof(ObjectNode*); i++)
+      setPointer(item.offset + i * sizeof(ObjectNode*), placeNode(table[i]));
+    break;
+  }
+}
+
+void freeWriter(void) {
+  free(moduleImage);
+  free(moduleRelocations);
+  free(moduleItems);
+  free(placements);
+  moduleImage = NULL;
+  moduleRelocations = NULL;
+  moduleItems = NULL;
+  placements = NULL;
+  moduleImageSize = moduleImageCapacity = 0;
+  moduleRelocationCount = moduleRelocationCapacity = 0;
+  moduleItemCount = moduleItemCapacity = 0;
+  placementSize = 0;
+}
+
+// Write program with every scope, object, type and constant value it
+// leads to
+int writeModule(char* fileName, Object* program) {
+  struct ModuleHeader* header;
+  FILE* f;
+  int i, ok;
+
+  growItems();
+  reserveSpace(sizeof(struct ModuleHeader));
+  setPointer(offsetof(struct ModuleHeader, program), placeObject(program));
+  for (i = 0; i < moduleItemCount; i++)
+    writeItem(moduleItems[i]);
+
+  header = (struct ModuleHeader*) moduleImage;
+  memcpy(header->magic, moduleMagic, sizeof(moduleMagic));
+  header->version = MODULE_VERSION;
+  header->pointerSize = sizeof(void*);
+  header->objectSize = sizeof(Object);
+  header->imageSize = moduleImageSize;
+  header->relocationCount = moduleRelocationCount;
+
+  f = fopen(fileName, "wb");
+  ok = (f != NULL);
+  if (ok) {
+    ok = (fwrite(moduleImage, 1, moduleImageSize, f) == (size_t) moduleImageSize)
+      && (fwrite(moduleRelocations, sizeof(int), moduleRelocationCount, f) == (size_t) moduleRelocationCount);
+    ok = (fclose(f) == 0) && ok;
+  }
+  freeWriter();
+  return ok ? IO_SUCCESS : IO_ERROR;
+}
+
+/******************* Loading ******************************/
+
+// Why a module cannot be loaded, or NULL if it can
+char* checkModuleHeader(struct ModuleHeader* header, off_t fileSize) {
+  if (fileSize < (off_t) sizeof(struct ModuleHeader))
+    return "truncated";
+  if (memcmp(header->magic, moduleMagic, sizeof(moduleMagic)) != 0)
+    return "not a KPL module";
+  if (header->version != MODULE_VERSION)
+    return "wrong module version";
+  if ((header->pointerSize != (int) sizeof(void*)) || (header->objectSize != (int) sizeof(Object)))
+    return "built for another object layout";
+  if ((header->imageSize % ALIGNMENT != 0) || (header->relocationCount < 0)
+      || (header->imageSize < (int) sizeof(struct ModuleHeader)))
+    return "corrupted";
+  if ((off_t) header->imageSize + (off_t) header->relocationCount * sizeof(int) > fileSize)
+    return "truncated";
+  if ((off_t) header->imageSize + (off_t) header->relocationCount * sizeof(int) < fileSize)
+    return "corrupted";
+  return NULL;
+}
+
+// Map fileName privately and relocate its pointers. NULL, with the reason
+// in moduleError, if it cannot be read or is not a module of this build:
+// the header is checked before anything is mapped. The layout of the file
+// is checked, not what the structures in it hold.
+Module* loadModule(char* fileName) {
+  struct ModuleHeader header;
+  struct stat st;
+  Module* module;
+  char* image;
+  int* relocations;
+  uintptr_t* slot;
+  int fd, i;
+
+  fd = open(fileName, O_RDONLY);
+  if (fd < 0) {
+    moduleError = "cannot open it";
+    return NULL;
+  }
+  if (fstat(fd, &st) < 0) st.st_size = 0;
+  if ((st.st_size >= (off_t) sizeof(header))
+      && (pread(fd, &header, sizeof(header), 0) != (ssize_t) sizeof(header)))
+    st.st_size = 0;
+  moduleError = checkModuleHeader(&header, st.st_size);
+  if (moduleError != NULL) {
+    close(fd);
+    return NULL;
+  }
+  image = (char*) mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (image == MAP_FAILED) {
+    moduleError = "cannot map it";
+    return NULL;
+  }
+
+  relocations = (int*) (image + header.imageSize);
+  for (i = 0; i < header.relocationCount; i++) {
+    if ((relocations[i] < 0) || (relocations[i] % ALIGNMENT != 0)
+	|| (relocations[i] > header.imageSize - (int) sizeof(void*)))
+      break;
+    slot = (uintptr_t*) (image + relocations[i]);
+    if ((*slot == 0) || (*slot >= (uintptr_t) header.imageSize)) break;
+    *slot += (uintptr_t) image;
+  }
+  if ((i < header.relocationCount) || (header.program == NULL)) {
+    munmap(image, st.st_size);
+    moduleError = "corrupted";
+    return NULL;
+  }
+
+  module = (Module*) malloc(sizeof(Module));
+  module->image = image;
+  module->size = st.st_size;
+  module->program = ((struct ModuleHeader*) image)->program;
+  return module;
+}
+
+void freeModule(Module* module) {
+  munmap(module->image, module->size);
+  free(module);
+}
@@ -0,0 +1,40 @@
+/*
+ * @copyright (c) 2026
+ * @author agent <agent@local>
+ * @version 1.0
+ */
+
+#ifndef __MODULE_H__
+#define __MODULE_H__
+
+#include <stddef.h>
+
+#include "symtab.h"
+
+// Bump whenever the layout of Object, Scope, ObjectNode, Type or
+// ConstantValue changes: a module is the memory image of those structures
+#define MODULE_VERSION 1
+
+// When set, compile() writes the declarations of an error-free program
+// to this file
+extern char* moduleFile;
+// Why the last loadModule() failed
+extern char* moduleError;
+
+// A module mapped back into memory. Its objects, scopes, types and
+// constant values are ordinary ones, shared by whatever refers to them as
+// they were at compile time and valid until freeModule(). Subprograms
+// have no bodies and scopes no arena.
+struct Module_ {
+  char* image;
+  size_t size;
+  Object* program;
+};
+
+typedef struct Module_ Module;
+
+int writeModule(char* fileName, Object* program);
+Module* loadModule(char* fileName);
+void freeModule(Module* module);
+
+#endif
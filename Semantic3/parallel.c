@@ -0,0 +1,285 @@
+/*
+ * @copyright (c) 2026
+ * @author agent <agent@local>
+ * @version 1.0
+ */
+
+#include <stdlib.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "tokenwin.h"
+#include "parser.h"
+#include "stackparser.h"
+#include "semantics.h"
+#include "idtable.h"
+#include "arena.h"
+#include "error.h"
+#include "trace.h"
+#include "parallel.h"
+#include "bodycache.h"
+
+extern _Thread_local Token *currentToken;
+extern _Thread_local Token *lookAhead;
+extern _Thread_local SymTab* symtab;
+extern Arena symtabArena;
+
+int parallelThreads = 0;
+
+struct BodyTask* tasks = NULL;
+int taskCount = 0;
+int taskCapacity = 0;
+
+// The symbol table as the pool found it; the main thread goes on changing
+// its own current scope
+SymTab sharedSymtab;
+atomic_int nextTask;
+pthread_t* workers = NULL;
+int workerCount = 0;
+
+// Set on the main thread while compileProgramParallel() runs
+_Thread_local int deferBodies = 0;
+
+// Hash of the tokens that declare what the next deferred block can see:
+// everything before the first function or procedure, then their headers
+unsigned long long envHash;
+
+/******************* Splitting ******************************/
+
+// Index of the END closing the block that starts at token start. Every
+// nested function or procedure has one BEGIN ... END of its own before
+// the block's. Returns -1 if BEGIN and END do not match.
+int findBlockEnd(int start) {
+  int depth = 0;
+  int pending = 0;
+  int i;
+
+  for (i = start; ; i++) {
+    switch (tokenAt(i)->tokenType) {
+    case KW_FUNCTION:
+    case KW_PROCEDURE:
+      if (depth == 0) pending ++;
+      break;
+    case KW_BEGIN:
+      depth ++;
+      break;
+    case KW_END:
+      if (depth == 0) return -1;
+      depth --;
+      if (depth == 0) {
+	if (pending == 0) return i;
+	pending --;
+      }
+      break;
+    case TK_EOF:
+      return -1;
+    default:
+      break;
+    }
+  }
+}
+
+// Parse the header of a function or procedure of the program and leave
+// its block to the pool. Returns 0 if the declaration is not one of the
+// program's, which is then parsed as usual.
+int deferSubDecl(void) {
+  Object* owner;
+  struct BodyTask* task;
+  int headerStart, lineNo;
+  int end;
+
+  if (!deferBodies || (symtab->currentScope != symtab->program->progAttrs.scope))
+    return 0;
+
+  if (taskCount == taskCapacity) {
+    taskCapacity = (taskCapacity == 0) ? 64 : 2 * taskCapacity;
+    tasks = (struct BodyTask*) realloc(tasks, taskCapacity * sizeof(struct BodyTask));
+  }
+  task = &tasks[taskCount++];
+  task->cached = NULL;
+  task->body = NULL;
+  task->arena = (Arena*) malloc(sizeof(Arena));
+  initArena(task->arena);
+  task->ok = 0;
+
+  // The subprogram's scope and parameters go with its block, so that the
+  // body cache can keep them past this compilation
+  headerStart = tokenIndex() - 1;
+  lineNo = lookAhead->lineNo;
+  symArena = task->arena;
+  if (lookAhead->tokenType == KW_FUNCTION)
+    owner = compileFuncHeader();
+  else owner = compileProcHeader();
+  symArena = &symtabArena;
+
+  end = findBlockEnd(tokenIndex() - 1);
+  if (end < 0) longjmp(*abortPoint, 1);
+
+  task->owner = owner;
+  task->lastVisible = symtab->program->progAttrs.scope->lastObject;
+  task->start = tokenIndex() - 1;
+  task->end = end;
+  task->lineNo = lineNo;
+  if (incremental) {
+    if (taskCount == 1)
+      envHash = hashTokens(HASH_BASIS, 0, headerStart, 0);
+    task->key = hashTokens(envHash, headerStart, end + 1, lineNo);
+    envHash = hashTokens(envHash, headerStart, task->start, 0);
+    task->cached = findCachedBody(task->key);
+  }
+
+  seekToken(end + 1);
+  free(lookAhead);
+  lookAhead = nextToken();
+  eat(SB_SEMICOLON);
+  exitBlock();
+  return 1;
+}
+
+/******************* Thread pool ******************************/
+
+// Parse one block on the calling thread, against its own view of the
+// symbol table. Any error abandons it.
+void parseBody(struct BodyTask* task) {
+  jmp_buf point;
+  SymTab view = sharedSymtab;
+
+  TRACE_RULE();
+  if (task->cached != NULL) {
+    task->ok = 1;
+    return;
+  }
+
+  symtab = &view;
+  // The block's nodes go with its symbols
+  symArena = task->arena;
+  nodeArena = task->arena;
+  initIdentTable();
+  if (task->owner->kind == OBJ_FUNCTION)
+    enterBlock(task->owner->funcAttrs.scope);
+  else enterBlock(task->owner->procAttrs.scope);
+  snapshotScope = sharedSymtab.program->progAttrs.scope;
+  snapshotLast = task->lastVisible;
+
+  recoveryPoint = NULL;
+  resynced = 0;
+  seekToken(task->start);
+  currentToken = NULL;
+  lookAhead = nextToken();
+
+  TRACE_MARK(depth);
+  if (setjmp(point) == 0) {
+    abortPoint = &point;
+    if (stackParse)
+      task->body = compileBlockIterative();
+    else task->body = compileBlock();
+    // The block must end exactly at the END it was matched with
+    task->ok = (tokenIndex() == task->end + 2);
+  } else {
+    TRACE_UNWIND(depth);
+    task->ok = 0;
+  }
+  abortPoint = NULL;
+
+  free(currentToken);
+  free(lookAhead);
+  freeParserStacks();
+  freeIdentTable();
+  symArena = NULL;
+  nodeArena = NULL;
+  symtab = NULL;
+  snapshotScope = NULL;
+  snapshotLast = NULL;
+}
+
+void* parseBodies(void* arg) {
+  int i;
+
+  while ((i = atomic_fetch_add(&nextTask, 1)) < taskCount)
+    parseBody(&tasks[i]);
+  return NULL;
+}
+
+// Start the pool once all of the program's functions and procedures are
+// declared; the main thread goes on with the program's own body meanwhile
+void startBodies(void) {
+  int i;
+
+  if (!deferBodies || (workerCount > 0) || (taskCount == 0))
+    return;
+
+  sharedSymtab = *symtab;
+  atomic_store(&nextTask, 0);
+  workerCount = (parallelThreads > 0) ? parallelThreads : 1;
+  if (workerCount > taskCount) workerCount = taskCount;
+  workers = (pthread_t*) malloc(workerCount * sizeof(pthread_t));
+  for (i = 0; i < workerCount; i++)
+    pthread_create(&workers[i], NULL, parseBodies, NULL);
+}
+
+// Wait for the pool and, if the rest of the program was parsed (ok),
+// attach the bodies to their owners in source order. Returns 0 if any
+// of them could not be parsed.
+int finishBodies(int ok) {
+  int i;
+
+  for (i = 0; i < workerCount; i++)
+    pthread_join(workers[i], NULL);
+  free(workers);
+  workers = NULL;
+  workerCount = 0;
+
+  for (i = 0; i < taskCount; i++)
+    if (!tasks[i].ok) ok = 0;
+
+  if (ok) {
+    for (i = 0; i < taskCount; i++)
+      if (tasks[i].cached == NULL)
+	setBody(tasks[i].owner, tasks[i].body);
+    if (incremental)
+      updateBodyCache(tasks, taskCount);
+  } else freeBodies();
+  return ok;
+}
+
+void freeBodies(void) {
+  int i;
+
+  for (i = 0; i < taskCount; i++)
+    if (tasks[i].arena != NULL) {
+      freeArena(tasks[i].arena);
+      free(tasks[i].arena);
+    }
+  free(tasks);
+  tasks = NULL;
+  taskCount = 0;
+  taskCapacity = 0;
+}
+
+/******************* Driver ******************************/
+
+// Parse the program from the token array with its functions' and
+// procedures' blocks parsed on the pool. The first error anywhere
+// abandons the attempt and 0 is returned; the caller then parses the
+// program again sequentially, so diagnostics are always those of an
+// ordinary run.
+int compileProgramParallel(void) {
+  jmp_buf point;
+  int ok = 1;
+
+  TRACE_MARK(depth);
+
+  deferBodies = 1;
+  if (setjmp(point) == 0) {
+    abortPoint = &point;
+    compileProgram();
+  } else {
+    TRACE_UNWIND(depth);
+    ok = 0;
+  }
+  abortPoint = NULL;
+  recoveryPoint = NULL;
+  deferBodies = 0;
+
+  return finishBodies(ok);
+}
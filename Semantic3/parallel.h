@@ -0,0 +1,39 @@
+/*
+ * @copyright (c) 2026
+ * @author agent <agent@local>
+ * @version 1.0
+ */
+
+#ifndef __PARALLEL_H__
+#define __PARALLEL_H__
+
+#include "symtab.h"
+#include "ast.h"
+#include "arena.h"
+
+struct CachedBody_;
+
+// A function or procedure of the program whose block is parsed by the pool
+struct BodyTask {
+  Object* owner;
+  ObjectNode* lastVisible;      // its own node in the program scope
+  int start;                    // first token of its block
+  int end;                      // the END closing its block
+  int lineNo;                   // line of its FUNCTION or PROCEDURE keyword
+  unsigned long long key;       // see bodycache.h
+  struct CachedBody_ *cached;   // the result to reuse instead of parsing
+  Node* body;
+  Arena* arena;                 // its scope, the objects and nodes of its block
+  int ok;
+};
+
+// Number of threads parsing the blocks of the program's functions and
+// procedures; 0 parses everything on the calling thread
+extern int parallelThreads;
+
+int compileProgramParallel(void);
+int deferSubDecl(void);
+void startBodies(void);
+void freeBodies(void);
+
+#endif
@@ -8,25 +8,88 @@
 
 #include "reader.h"
 #include "scanner.h"
+#include "tokenwin.h"
 #include "parser.h"
+#include "stackparser.h"
+#include "llparser.h"
+#include "parallel.h"
+#include "bodycache.h"
 #include "semantics.h"
+#include "ast.h"
+#include "grammar.h"
+#include "lltable.h"
 #include "error.h"
+#include "trace.h"
 #include "debug.h"
+#include "module.h"
 
-Token *currentToken;
-Token *lookAhead;
+// Each thread parsing a subprogram body has its own position
+_Thread_local Token *currentToken;
+_Thread_local Token *lookAhead;
+
+int printTree = 0;
+int skipBodies = 0;
 
 extern Type* intType;
 extern Type* charType;
-extern SymTab* symtab;
+extern _Thread_local SymTab* symtab;
+
+/******************* Error recovery ******************************/
+
+// Set when the last statement was abandoned after an error
+_Thread_local int resynced = 0;
+
+void skipTo(TokenSet syncSet) {
+  while (!IN_SET(syncSet, lookAhead->tokenType))
+    scan();
+}
+
+// Run compileFn with its own recovery point. After an error the scope is
+// restored, tokens are skipped up to one in syncSet and 0 is returned.
+int compileWithRecovery(void (*compileFn)(void), TokenSet syncSet) {
+  jmp_buf point;
+  jmp_buf *outer = recoveryPoint;
+  Scope* scope = symtab->currentScope;
+  int ok = 1;
+  TRACE_MARK(depth);
+
+  if (setjmp(point) == 0) {
+    recoveryPoint = &point;
+    compileFn();
+  } else {
+    TRACE_UNWIND(depth);
+    recoveryPoint = outer;
+    restoreBlock(scope);
+    skipTo(syncSet);
+    ok = 0;
+  }
+  recoveryPoint = outer;
+  return ok;
+}
+
+// A constant, type or variable declaration; a broken one is skipped up to
+// its terminating ';'
+void compileDecl(void (*compileFn)(void)) {
+  if (!compileWithRecovery(compileFn, DECL_SYNC) && (lookAhead->tokenType == SB_SEMICOLON))
+    eat(SB_SEMICOLON);
+}
+
+/******************* Parser ******************************/
 
 void scan(void) {
   Token* tmp = currentToken;
   currentToken = lookAhead;
-  lookAhead = getValidToken();
+  lookAhead = nextToken();
   free(tmp);
 }
 
+// Look k tokens past the lookahead without consuming anything:
+// peek(0) is lookAhead itself
+Token* peek(int k) {
+  if (k == 0) return lookAhead;
+  return peekToken(k - 1);
+}
+
 void eat(TokenType tokenType) {
   if (lookAhead->tokenType == tokenType) {
     scan();
@@ -36,130 +99,231 @@ void eat(TokenType tokenType) {
 void compileProgram(void) {
   Object* program;
 
+  TRACE_RULE();
   eat(KW_PROGRAM);
   eat(TK_IDENT);
 
   program = createProgramObject(currentToken->string);
-  enterBlock(program->progAttrs->scope);
+  enterBlock(program->progAttrs.scope);
 
   eat(SB_SEMICOLON);
 
-  compileBlock();
+  // Skipping blocks nests no deeper than the program's declarations
+  if (stackParse && !skipBodies)
+    program->progAttrs.body = compileBlockIterative();
+  else program->progAttrs.body = compileBlock();
   eat(SB_PERIOD);
 
   exitBlock();
 }
 
-void compileBlock(void) {
-  Object* constObj;
-  ConstantValue* constValue;
+Node* compileBlock(void) {
+  TRACE_RULE();
+  compileConstDecls();
+  return compileBlock2();
+}
+
+Node* compileBlock2(void) {
+  TRACE_RULE();
+  compileTypeDecls();
+  return compileBlock3();
+}
+
+Node* compileBlock3(void) {
+  TRACE_RULE();
+  compileVarDecls();
+  return compileBlock4();
+}
 
+void compileConstDecls(void) {
+  TRACE_RULE();
   if (lookAhead->tokenType == KW_CONST) {
     eat(KW_CONST);
 
     do {
-      eat(TK_IDENT);
-      // TODO: Check if a constant identifier is fresh in the block
-      checkFreshIdent(currentToken->string);
-      // Create a constant object
-      constObj = createConstantObject(currentToken->string);
-      
-      eat(SB_EQ);
-      // Get the constant value
-      constValue = compileConstant();
-      constObj->constAttrs->value = constValue;
-      // Declare the constant object 
-      declareObject(constObj);
-      
-      eat(SB_SEMICOLON);
+      compileDecl(compileConstDecl);
     } while (lookAhead->tokenType == TK_IDENT);
-
-    compileBlock2();
-  } 
-  else compileBlock2();
+  }
 }
 
-void compileBlock2(void) {
-  Object* typeObj;
-  Type* actualType;
+void compileConstDecl(void) {
+  Object* constObj;
+  ConstantValue* constValue;
+
+  TRACE_RULE();
+  eat(TK_IDENT);
+  // TODO: Check if a constant identifier is fresh in the block
+  checkFreshIdent(currentToken->string);
+  // Create a constant object
+  constObj = createConstantObject(currentToken->string);
+
+  eat(SB_EQ);
+  // Get the constant value
+  constValue = compileConstant();
+  constObj->constAttrs.value = constValue;
+  // Declare the constant object 
+  declareObject(constObj);
+
+  eat(SB_SEMICOLON);
+}
 
+void compileTypeDecls(void) {
+  TRACE_RULE();
   if (lookAhead->tokenType == KW_TYPE) {
     eat(KW_TYPE);
 
     do {
-      eat(TK_IDENT);
-      // TODO: Check if a type identifier is fresh in the block
-      checkFreshIdent(currentToken->string);
-      // create a type object
-      typeObj = createTypeObject(currentToken->string);
-      
-      eat(SB_EQ);
-      // Get the actual type
-      actualType = compileType();
-      typeObj->typeAttrs->actualType = actualType;
-      // Declare the type object
-      declareObject(typeObj);
-      
-      eat(SB_SEMICOLON);
+      compileDecl(compileTypeDecl);
     } while (lookAhead->tokenType == TK_IDENT);
-
-    compileBlock3();
-  } 
-  else compileBlock3();
+  }
 }
 
-void compileBlock3(void) {
-  Object* varObj;
-  Type* varType;
+void compileTypeDecl(void) {
+  Object* typeObj;
+  Type* actualType;
+
+  TRACE_RULE();
+  eat(TK_IDENT);
+  // TODO: Check if a type identifier is fresh in the block
+  checkFreshIdent(currentToken->string);
+  // create a type object
+  typeObj = createTypeObject(currentToken->string);
 
+  eat(SB_EQ);
+  // Get the actual type
+  actualType = compileType();
+  typeObj->typeAttrs.actualType = actualType;
+  // Declare the type object
+  declareObject(typeObj);
+
+  eat(SB_SEMICOLON);
+}
+
+void compileVarDecls(void) {
+  TRACE_RULE();
   if (lookAhead->tokenType == KW_VAR) {
     eat(KW_VAR);
 
     do {
-      eat(TK_IDENT);
-      // TODO: Check if a variable identifier is fresh in the block
-      checkFreshIdent(currentToken->string);
-      // Create a variable object      
-      varObj = createVariableObject(currentToken->string);
-
-      eat(SB_COLON);
-      // Get the variable type
-      varType = compileType();
-      varObj->varAttrs->type = varType;
-      // Declare the variable object
-      declareObject(varObj);
-      
-      eat(SB_SEMICOLON);
+      compileDecl(compileVarDecl);
     } while (lookAhead->tokenType == TK_IDENT);
+  }
+}
 
-    compileBlock4();
-  } 
-  else compileBlock4();
+void compileVarDecl(void) {
+  Object* varObj;
+  Type* varType;
+
+  TRACE_RULE();
+  eat(TK_IDENT);
+  // TODO: Check if a variable identifier is fresh in the block
+  checkFreshIdent(currentToken->string);
+  // Create a variable object
+  varObj = createVariableObject(currentToken->string);
+
+  eat(SB_COLON);
+  // Get the variable type
+  varType = compileType();
+  varObj->varAttrs.type = varType;
+  checkFrameSpace(varType);
+  // Declare the variable object
+  declareObject(varObj);
+
+  eat(SB_SEMICOLON);
 }
 
-void compileBlock4(void) {
+Node* compileBlock4(void) {
+  TRACE_RULE();
   compileSubDecls();
-  compileBlock5();
+  startBodies();
+  return compileBlock5();
 }
 
-void compileBlock5(void) {
+Node* compileBlock5(void) {
+  Node* body;
+
+  TRACE_RULE();
+  if (skipBodies) {
+    skipBlock();
+    return NULL;
+  }
+  body = makeNode(N_GROUP, lookAhead->lineNo, lookAhead->colNo);
   eat(KW_BEGIN);
-  compileStatements();
+  body->group.stmts = compileStatements();
   eat(KW_END);
+  return body;
+}
+
+// Pass over the rest of a block, up to and including the END closing it,
+// by counting BEGIN and END alone. Each nested function or procedure has
+// one BEGIN ... END of its own before the block's.
+void skipBlock(void) {
+  int depth = 0;
+  int pending = 0;
+
+  TRACE_RULE();
+  for (;;) {
+    switch (lookAhead->tokenType) {
+    case KW_FUNCTION:
+    case KW_PROCEDURE:
+      if (depth == 0) pending ++;
+      break;
+    case KW_BEGIN:
+      depth ++;
+      break;
+    case KW_END:
+      if (depth == 0) {
+	error(ERR_INVALID_STATEMENT, lookAhead->lineNo, lookAhead->colNo);
+	return;
+      }
+      depth --;
+      if (depth == 0) {
+	if (pending == 0) {
+	  scan();
+	  return;
+	}
+	pending --;
+      }
+      break;
+    case TK_EOF:
+      missingToken(KW_END, lookAhead->lineNo, lookAhead->colNo);
+      return;
+    default:
+      break;
+    }
+    scan();
+  }
 }
 
 void compileSubDecls(void) {
+  TRACE_RULE();
   while ((lookAhead->tokenType == KW_FUNCTION) || (lookAhead->tokenType == KW_PROCEDURE)) {
+    if (!skipBodies && deferSubDecl()) continue;
     if (lookAhead->tokenType == KW_FUNCTION)
-      compileFuncDecl();
-    else compileProcDecl();
+      compileWithRecovery(compileFuncDecl, SUBDECL_SYNC);
+    else compileWithRecovery(compileProcDecl, SUBDECL_SYNC);
   }
 }
 
 void compileFuncDecl(void) {
   Object* funcObj;
+
+  TRACE_RULE();
+  funcObj = compileFuncHeader();
+  if (skipBodies) skipBlock();
+  else funcObj->funcAttrs.body = compileBlock();
+  eat(SB_SEMICOLON);
+  // exit the function block
+  exitBlock();
+}
+
+// Everything of a function declaration up to its block; the function's
+// scope is left open
+Object* compileFuncHeader(void) {
+  Object* funcObj;
   Type* returnType;
 
+  TRACE_RULE();
   eat(KW_FUNCTION);
   eat(TK_IDENT);
   // TODO: Check if a function identifier is fresh in the block
@@ -169,24 +333,34 @@ void compileFuncDecl(void) {
   // declare the function object
   declareObject(funcObj);
   // enter the function's block
-  enterBlock(funcObj->funcAttrs->scope);
+  enterBlock(funcObj->funcAttrs.scope);
   // parse the function's parameters
   compileParams();
   eat(SB_COLON);
   // get the funtion's return type
   returnType = compileBasicType();
-  funcObj->funcAttrs->returnType = returnType;
+  funcObj->funcAttrs.returnType = returnType;
 
   eat(SB_SEMICOLON);
-  compileBlock();
+  return funcObj;
+}
+
+void compileProcDecl(void) {
+  Object* procObj;
+
+  TRACE_RULE();
+  procObj = compileProcHeader();
+  if (skipBodies) skipBlock();
+  else procObj->procAttrs.body = compileBlock();
   eat(SB_SEMICOLON);
-  // exit the function block
+  // exit the block
   exitBlock();
 }
 
-void compileProcDecl(void) {
+Object* compileProcHeader(void) {
   Object* procObj;
 
+  TRACE_RULE();
   eat(KW_PROCEDURE);
   eat(TK_IDENT);
   // TODO: Check if a procedure identifier is fresh in the block
@@ -196,21 +370,19 @@ void compileProcDecl(void) {
   // declare the procedure object
   declareObject(procObj);
   // enter the procedure's block
-  enterBlock(procObj->procAttrs->scope);
+  enterBlock(procObj->procAttrs.scope);
   // parse the procedure's parameters
   compileParams();
 
   eat(SB_SEMICOLON);
-  compileBlock();
-  eat(SB_SEMICOLON);
-  // exit the block
-  exitBlock();
+  return procObj;
 }
 
 ConstantValue* compileUnsignedConstant(void) {
   ConstantValue* constValue = NULL;
   Object* obj;
 
+  TRACE_RULE();
   switch (lookAhead->tokenType) {
   case TK_NUMBER:
     eat(TK_NUMBER);
@@ -221,7 +393,7 @@ ConstantValue* compileUnsignedConstant(void) {
     // TODO: check if the constant identifier is declared and get its value
     obj = checkDeclaredConstant(currentToken->string);
     if (obj != NULL)
-        constValue = duplicateConstantValue(obj->constAttrs->value);
+        constValue = duplicateConstantValue(obj->constAttrs.value);
     else
         error(ERR_UNDECLARED_CONSTANT, currentToken->lineNo, currentToken->colNo);
     break;
@@ -236,22 +408,22 @@ ConstantValue* compileUnsignedConstant(void) {
   return constValue;
 }
 
+// A constant expression, evaluated as it is parsed. As in expressions,
+// the sign applies to the whole sum after it.
 ConstantValue* compileConstant(void) {
   ConstantValue* constValue;
 
+  TRACE_RULE();
   switch (lookAhead->tokenType) {
   case SB_PLUS:
     eat(SB_PLUS);
     constValue = compileConstant2();
+    checkIntConstant(constValue);
     break;
   case SB_MINUS:
     eat(SB_MINUS);
     constValue = compileConstant2();
-    constValue->intValue = - constValue->intValue;
-    break;
-  case TK_CHAR:
-    eat(TK_CHAR);
-    constValue = makeCharConstant(currentToken->string[0]);
+    negateConstant(constValue);
     break;
   default:
     constValue = compileConstant2();
@@ -261,28 +433,27 @@ ConstantValue* compileConstant(void) {
 }
 
 ConstantValue* compileConstant2(void) {
-  ConstantValue* constValue = NULL;
-  Object* obj;
+  TRACE_RULE();
+  return compileConstantBinary(1);
+}
 
-  switch (lookAhead->tokenType) {
-  case TK_NUMBER:
-    eat(TK_NUMBER);
-    constValue = makeIntConstant(currentToken->value);
-    break;
-  case TK_IDENT:
-    eat(TK_IDENT);
-    // TODO: check if the integer constant identifier is declared and get its value
-    obj = checkDeclaredConstant(currentToken->string);
-    if (obj != NULL)
-        constValue = duplicateConstantValue(obj->constAttrs->value);
-    else
-        error(ERR_UNDECLARED_CONSTANT, currentToken->colNo, currentToken->lineNo);
-    break;
-  default:
-    error(ERR_INVALID_CONSTANT, lookAhead->lineNo, lookAhead->colNo);
-    break;
+// Precedence climbing over constants, as compileBinary() does over
+// expressions
+ConstantValue* compileConstantBinary(int minPrecedence) {
+  ConstantValue* left;
+  ConstantValue* right;
+  TokenType op;
+  int precedence;
+
+  TRACE_RULE();
+  left = compileUnsignedConstant();
+  while ((precedence = binaryPrecedence(lookAhead->tokenType)) >= minPrecedence) {
+    op = lookAhead->tokenType;
+    eat(op);
+    right = compileConstantBinary(precedence + 1);
+    foldConstant(op, left, right);
   }
-  return constValue;
+  return left;
 }
 
 Type* compileType(void) {
@@ -291,6 +462,7 @@ Type* compileType(void) {
   int arraySize;
   Object* obj;
 
+  TRACE_RULE();
   switch (lookAhead->tokenType) {
   case KW_INTEGER: 
     eat(KW_INTEGER);
@@ -303,13 +475,11 @@ Type* compileType(void) {
   case KW_ARRAY:
     eat(KW_ARRAY);
     eat(SB_LSEL);
-    eat(TK_NUMBER);
-
-    arraySize = currentToken->value;
-
+    arraySize = checkArraySize(compileConstant());
     eat(SB_RSEL);
     eat(KW_OF);
     elementType = compileType();
+    checkArrayWords(arraySize, elementType);
     type = makeArrayType(arraySize, elementType);
     break;
   case TK_IDENT:
@@ -317,7 +487,7 @@ Type* compileType(void) {
     // TODO: check if the type idntifier is declared and get its actual type
     obj = checkDeclaredType(currentToken->string);
     if (obj != NULL)
-        type = duplicateType(obj->typeAttrs->actualType);
+        type = obj->typeAttrs.actualType;
     else
         error(ERR_UNDECLARED_TYPE, currentToken->colNo, currentToken->lineNo);
     break;
@@ -331,6 +501,7 @@ Type* compileType(void) {
 Type* compileBasicType(void) {
   Type* type = NULL;
 
+  TRACE_RULE();
   switch (lookAhead->tokenType) {
   case KW_INTEGER: 
     eat(KW_INTEGER); 
@@ -348,6 +519,7 @@ Type* compileBasicType(void) {
 }
 
 void compileParams(void) {
+  TRACE_RULE();
   if (lookAhead->tokenType == SB_LPAR) {
     eat(SB_LPAR);
     compileParam();
@@ -364,6 +536,7 @@ void compileParam(void) {
   Type* type;
   enum ParamKind paramKind;
 
+  TRACE_RULE();
   switch (lookAhead->tokenType) {
   case TK_IDENT:
     paramKind = PARAM_VALUE; // tham tri
@@ -383,298 +556,383 @@ void compileParam(void) {
   param = createParameterObject(currentToken->string, paramKind, symtab->currentScope->owner);
   eat(SB_COLON);
   type = compileBasicType();
-  param->paramAttrs->type = type;
+  param->paramAttrs.type = type;
   declareObject(param);
 }
 
-void compileStatements(void) {
-  compileStatement();
-  while (lookAhead->tokenType == SB_SEMICOLON) {
-    eat(SB_SEMICOLON);
-    compileStatement();
+NodeList* compileStatements(void) {
+  NodeList* stmts = NULL;
+  NodeList** tail = &stmts;
+
+  TRACE_RULE();
+  tail = appendNode(tail, compileStatement());
+  for (;;) {
+    if (lookAhead->tokenType == SB_SEMICOLON)
+      eat(SB_SEMICOLON);
+    // After resynchronizing on the first token of a statement, parse it
+    // as the next one instead of reporting a missing ';'
+    else if (!(resynced && IN_SET(STATEMENT_START, lookAhead->tokenType)))
+      break;
+    tail = appendNode(tail, compileStatement());
+  }
+  return stmts;
+}
+
+Node* compileStatement(void) {
+  jmp_buf point;
+  jmp_buf *outer = recoveryPoint;
+  Node* stmt;
+
+  TRACE_RULE();
+  TRACE_MARK(depth);
+  if (setjmp(point) == 0) {
+    recoveryPoint = &point;
+    stmt = compileStatementBody();
+    resynced = 0;
+  } else {
+    TRACE_UNWIND(depth);
+    recoveryPoint = outer;
+    skipTo(STATEMENT_SYNC);
+    stmt = makeNode(N_EMPTY, lookAhead->lineNo, lookAhead->colNo);
+    resynced = 1;
   }
+  recoveryPoint = outer;
+  return stmt;
 }
 
-void compileStatement(void) {
+Node* compileStatementBody(void) {
+  Node* stmt = NULL;
+
+  TRACE_RULE();
   switch (lookAhead->tokenType) {
   case TK_IDENT:
-    compileAssignSt();
+    stmt = compileAssignSt();
     break;
   case KW_CALL:
-    compileCallSt();
+    stmt = compileCallSt();
     break;
   case KW_BEGIN:
-    compileGroupSt();
+    stmt = compileGroupSt();
     break;
   case KW_IF:
-    compileIfSt();
+    stmt = compileIfSt();
     break;
   case KW_WHILE:
-    compileWhileSt();
+    stmt = compileWhileSt();
     break;
   case KW_FOR:
-    compileForSt();
-    break;
-    // EmptySt needs to check FOLLOW tokens
-  case SB_SEMICOLON:
-  case KW_END:
-  case KW_ELSE:
+    stmt = compileForSt();
     break;
-    // Error occurs
   default:
-    error(ERR_INVALID_STATEMENT, lookAhead->lineNo, lookAhead->colNo);
+    // EmptySt needs to check FOLLOW tokens
+    if (IN_SET(followSets[NT_STATEMENT], lookAhead->tokenType))
+      stmt = makeNode(N_EMPTY, lookAhead->lineNo, lookAhead->colNo);
+    else error(ERR_INVALID_STATEMENT, lookAhead->lineNo, lookAhead->colNo);
     break;
   }
+  return stmt;
 }
 
-void compileLValue(void) {
+Node* compileLValue(void) {
   Object* var;
+  Node* lvalue;
 
+  TRACE_RULE();
   eat(TK_IDENT);
-  // check if the identifier is a function identifier, or a variable identifier, or a parameter  
+  // check if the identifier is a function identifier, or a variable identifier, or a parameter
   var = checkDeclaredLValueIdent(currentToken->string);
+  lvalue = makeNode(N_VARIABLE, currentToken->lineNo, currentToken->colNo);
+  lvalue->var.obj = var;
+  lvalue->type = typeOfObject(var);
+  resolveAddress(var, &lvalue->var.addr);
   if (var->kind == OBJ_VARIABLE)
-    compileIndexes();
+    lvalue->var.indexes = compileIndexes(lvalue);
+  return lvalue;
 }
 
-void compileAssignSt(void) {
-  compileLValue();
+Node* compileAssignSt(void) {
+  Node* stmt = makeNode(N_ASSIGN, lookAhead->lineNo, lookAhead->colNo);
+
+  TRACE_RULE();
+  stmt->assign.lvalue = compileLValue();
   eat(SB_ASSIGN);
-  compileExpression();
+  stmt->assign.expr = compileExpression();
+  checkTypeEquality(stmt->assign.lvalue->type, stmt->assign.expr->type);
+  return stmt;
 }
 
-void compileCallSt(void) {
+Node* compileCallSt(void) {
+  Node* stmt = makeNode(N_CALL, lookAhead->lineNo, lookAhead->colNo);
+
+  TRACE_RULE();
   eat(KW_CALL);
   eat(TK_IDENT);
   // TODO: check if the identifier is a declared procedure
   Object *obj = checkDeclaredProcedure(currentToken->string);
   if (obj == NULL)
       error(ERR_UNDECLARED_PROCEDURE, currentToken->lineNo, currentToken->colNo);
-  compileArguments();
+  stmt->call.obj = obj;
+  stmt->call.args = compileArguments();
+  checkArguments(stmt);
+  return stmt;
 }
 
-void compileGroupSt(void) {
+Node* compileGroupSt(void) {
+  Node* stmt = makeNode(N_GROUP, lookAhead->lineNo, lookAhead->colNo);
+
+  TRACE_RULE();
   eat(KW_BEGIN);
-  compileStatements();
+  stmt->group.stmts = compileStatements();
   eat(KW_END);
+  return stmt;
 }
 
-void compileIfSt(void) {
+Node* compileIfSt(void) {
+  Node* stmt;
+
+  TRACE_RULE();
+  stmt = compileIfHead();
+  stmt->ifSt.thenSt = compileStatement();
+  if (lookAhead->tokenType == KW_ELSE)
+    stmt->ifSt.elseSt = compileElseSt();
+  return stmt;
+}
+
+// The parts of an if statement before its THEN branch
+Node* compileIfHead(void) {
+  Node* stmt = makeNode(N_IF, lookAhead->lineNo, lookAhead->colNo);
+
+  TRACE_RULE();
   eat(KW_IF);
-  compileCondition();
+  stmt->ifSt.cond = compileCondition();
   eat(KW_THEN);
-  compileStatement();
-  if (lookAhead->tokenType == KW_ELSE) 
-    compileElseSt();
+  return stmt;
 }
 
-void compileElseSt(void) {
+Node* compileElseSt(void) {
+  TRACE_RULE();
   eat(KW_ELSE);
-  compileStatement();
+  return compileStatement();
+}
+
+Node* compileWhileSt(void) {
+  Node* stmt;
+
+  TRACE_RULE();
+  stmt = compileWhileHead();
+  stmt->whileSt.body = compileStatement();
+  return stmt;
 }
 
-void compileWhileSt(void) {
+Node* compileWhileHead(void) {
+  Node* stmt = makeNode(N_WHILE, lookAhead->lineNo, lookAhead->colNo);
+
+  TRACE_RULE();
   eat(KW_WHILE);
-  compileCondition();
+  stmt->whileSt.cond = compileCondition();
   eat(KW_DO);
-  compileStatement();
+  return stmt;
+}
+
+Node* compileForSt(void) {
+  Node* stmt;
+
+  TRACE_RULE();
+  stmt = compileForHead();
+  stmt->forSt.body = compileStatement();
+  return stmt;
 }
 
-void compileForSt(void) {
+Node* compileForHead(void) {
+  Node* stmt = makeNode(N_FOR, lookAhead->lineNo, lookAhead->colNo);
+
+  TRACE_RULE();
   eat(KW_FOR);
   eat(TK_IDENT);
 
   // TODO: check if the identifier is a variable
-  if (checkDeclaredVariable(currentToken->string) == NULL)
+  stmt->forSt.var = checkDeclaredVariable(currentToken->string);
+  if (stmt->forSt.var == NULL)
       error(ERR_UNDECLARED_VARIABLE, currentToken->lineNo, currentToken->colNo);
+  resolveAddress(stmt->forSt.var, &stmt->forSt.addr);
 
   eat(SB_ASSIGN);
-  compileExpression();
+  stmt->forSt.from = compileExpression();
+  checkBasicType(stmt->forSt.var->varAttrs.type);
+  checkTypeEquality(stmt->forSt.var->varAttrs.type, stmt->forSt.from->type);
 
   eat(KW_TO);
-  compileExpression();
+  stmt->forSt.to = compileExpression();
+  checkTypeEquality(stmt->forSt.var->varAttrs.type, stmt->forSt.to->type);
 
   eat(KW_DO);
-  compileStatement();
+  return stmt;
 }
 
-void compileArgument(void) {
-  compileExpression();
+Node* compileArgument(void) {
+  TRACE_RULE();
+  return compileExpression();
 }
 
-void compileArguments(void) {
-  switch (lookAhead->tokenType) {
-  case SB_LPAR:
+// The arguments of a call statement or of a function in a factor, which
+// kpl.grammar puts in Selector: the FOLLOW set of either may end them
+NodeList* compileArguments(void) {
+  NodeList* args = NULL;
+  NodeList** tail = &args;
+
+  TRACE_RULE();
+  if (lookAhead->tokenType == SB_LPAR) {
     eat(SB_LPAR);
-    compileArgument();
+    tail = appendNode(tail, compileArgument());
 
     while (lookAhead->tokenType == SB_COMMA) {
       eat(SB_COMMA);
-      compileArgument();
+      tail = appendNode(tail, compileArgument());
     }
-    
+
     eat(SB_RPAR);
-    break;
-    // Check FOLLOW set 
-  case SB_TIMES:
-  case SB_SLASH:
-  case SB_PLUS:
-  case SB_MINUS:
-  case KW_TO:
-  case KW_DO:
-  case SB_RPAR:
-  case SB_COMMA:
-  case SB_EQ:
-  case SB_NEQ:
-  case SB_LE:
-  case SB_LT:
-  case SB_GE:
-  case SB_GT:
-  case SB_RSEL:
-  case SB_SEMICOLON:
-  case KW_END:
-  case KW_ELSE:
-  case KW_THEN:
-    break;
-  default:
+  } else if (!IN_SET(followSets[NT_ARGUMENTS] | followSets[NT_SELECTOR], lookAhead->tokenType))
     error(ERR_INVALID_ARGUMENTS, lookAhead->lineNo, lookAhead->colNo);
-  }
+  return args;
 }
 
-void compileCondition(void) {
-  compileExpression();
+Node* compileCondition(void) {
+  Node* cond = makeNode(N_CONDITION, lookAhead->lineNo, lookAhead->colNo);
+
+  TRACE_RULE();
+  cond->binary.left = compileExpression();
 
   switch (lookAhead->tokenType) {
   case SB_EQ:
-    eat(SB_EQ);
-    break;
   case SB_NEQ:
-    eat(SB_NEQ);
-    break;
   case SB_LE:
-    eat(SB_LE);
-    break;
   case SB_LT:
-    eat(SB_LT);
-    break;
   case SB_GE:
-    eat(SB_GE);
-    break;
   case SB_GT:
-    eat(SB_GT);
+    cond->binary.op = lookAhead->tokenType;
+    eat(lookAhead->tokenType);
     break;
   default:
     error(ERR_INVALID_COMPARATOR, lookAhead->lineNo, lookAhead->colNo);
   }
 
-  compileExpression();
+  cond->binary.right = compileExpression();
+  checkBasicType(cond->binary.left->type);
+  checkTypeEquality(cond->binary.left->type, cond->binary.right->type);
+  return cond;
 }
 
-void compileExpression(void) {
+Node* compileExpression(void) {
+  Node* expr;
+
+  TRACE_RULE();
   switch (lookAhead->tokenType) {
   case SB_PLUS:
     eat(SB_PLUS);
-    compileExpression2();
+    expr = compileExpression2();
+    checkIntType(expr->type);
     break;
   case SB_MINUS:
     eat(SB_MINUS);
-    compileExpression2();
+    expr = makeNode(N_UNARY, currentToken->lineNo, currentToken->colNo);
+    expr->unary.op = SB_MINUS;
+    expr->unary.operand = compileExpression2();
+    checkIntType(expr->unary.operand->type);
+    expr->type = makeIntType();
+    foldUnary(expr);
     break;
   default:
-    compileExpression2();
+    expr = compileExpression2();
   }
+  return expr;
 }
 
-void compileExpression2(void) {
-  compileTerm();
-  compileExpression3();
+Node* compileExpression2(void) {
+  TRACE_RULE();
+  return compileBinary(1);
 }
 
-
-void compileExpression3(void) {
-  switch (lookAhead->tokenType) {
+// Binding power of a binary operator; 0 for any other token
+int binaryPrecedence(TokenType tokenType) {
+  switch (tokenType) {
   case SB_PLUS:
-    eat(SB_PLUS);
-    compileTerm();
-    compileExpression3();
-    break;
   case SB_MINUS:
-    eat(SB_MINUS);
-    compileTerm();
-    compileExpression3();
-    break;
-    // check the FOLLOW set
-  case KW_TO:
-  case KW_DO:
-  case SB_RPAR:
-  case SB_COMMA:
-  case SB_EQ:
-  case SB_NEQ:
-  case SB_LE:
-  case SB_LT:
-  case SB_GE:
-  case SB_GT:
-  case SB_RSEL:
-  case SB_SEMICOLON:
-  case KW_END:
-  case KW_ELSE:
-  case KW_THEN:
-    break;
+    return 1;
+  case SB_TIMES:
+  case SB_SLASH:
+    return 2;
   default:
-    error(ERR_INVALID_EXPRESSION, lookAhead->lineNo, lookAhead->colNo);
+    return 0;
   }
 }
 
-void compileTerm(void) {
-  compileFactor();
-  compileTerm2();
+// Check the token after a factor: another operator or the FOLLOW set of a term
+void checkTermFollow(void) {
+  if (!IN_SET(firstSets[NT_TERM2] | followSets[NT_TERM2], lookAhead->tokenType))
+    error(ERR_INVALID_TERM, lookAhead->lineNo, lookAhead->colNo);
 }
 
-void compileTerm2(void) {
-  switch (lookAhead->tokenType) {
-  case SB_TIMES:
-    eat(SB_TIMES);
-    compileFactor();
-    compileTerm2();
-    break;
-  case SB_SLASH:
-    eat(SB_SLASH);
-    compileFactor();
-    compileTerm2();
-    break;
-    // check the FOLLOW set
-  case SB_PLUS:
-  case SB_MINUS:
-  case KW_TO:
-  case KW_DO:
-  case SB_RPAR:
-  case SB_COMMA:
-  case SB_EQ:
-  case SB_NEQ:
-  case SB_LE:
-  case SB_LT:
-  case SB_GE:
-  case SB_GT:
-  case SB_RSEL:
-  case SB_SEMICOLON:
-  case KW_END:
-  case KW_ELSE:
-  case KW_THEN:
-    break;
-  default:
-    error(ERR_INVALID_TERM, lookAhead->lineNo, lookAhead->colNo);
+// Check the token after a whole expression against its FOLLOW set
+void checkExpressionFollow(void) {
+  if (!IN_SET(followSets[NT_EXPRESSION], lookAhead->tokenType))
+    error(ERR_INVALID_EXPRESSION, lookAhead->lineNo, lookAhead->colNo);
+}
+
+// Build a binary node for the operator just eaten, with left as its left operand
+Node* makeBinary(Node* left) {
+  Node* expr = makeNode(N_BINARY, currentToken->lineNo, currentToken->colNo);
+
+  checkIntType(left->type);
+  expr->type = makeIntType();
+  expr->binary.op = currentToken->tokenType;
+  expr->binary.left = left;
+  return expr;
+}
+
+// Precedence climbing: parse operands joined by operators that bind at
+// least as tightly as minPrecedence. Operators of one level are handled by
+// the loop, so recursion depth is bounded by the number of levels rather
+// than by the length of the expression.
+Node* compileBinary(int minPrecedence) {
+  Node* left;
+  int precedence;
+
+  TRACE_RULE();
+  left = compileFactor();
+  // The operand of * or / is a single factor, which the caller checks and
+  // folds before the token after it, as the table-driven parser does
+  if (minPrecedence > 2) return left;
+  checkTermFollow();
+  while ((precedence = binaryPrecedence(lookAhead->tokenType)) >= minPrecedence) {
+    eat(lookAhead->tokenType);
+    left = makeBinary(left);
+    left->binary.right = compileBinary(precedence + 1);
+    checkIntType(left->binary.right->type);
+    foldBinary(left);
+    if (precedence == 2) checkTermFollow();
   }
+
+  if (minPrecedence == 1) checkExpressionFollow();
+  return left;
 }
 
-void compileFactor(void) {
+Node* compileFactor(void) {
   Object* obj;
+  Node* factor = NULL;
 
+  TRACE_RULE();
   switch (lookAhead->tokenType) {
   case TK_NUMBER:
     eat(TK_NUMBER);
+    factor = makeNode(N_NUMBER, currentToken->lineNo, currentToken->colNo);
+    factor->value = currentToken->value;
+    factor->type = makeIntType();
     break;
   case TK_CHAR:
     eat(TK_CHAR);
+    factor = makeNode(N_CHAR, currentToken->lineNo, currentToken->colNo);
+    factor->value = currentToken->string[0];
+    factor->type = makeCharType();
     break;
   case TK_IDENT:
     eat(TK_IDENT);
@@ -683,16 +941,31 @@ void compileFactor(void) {
 
     switch (obj->kind) {
     case OBJ_CONSTANT:
+      factor = makeNode(N_CONSTANT, currentToken->lineNo, currentToken->colNo);
+      factor->var.obj = obj;
+      factor->type = typeOfObject(obj);
       break;
     case OBJ_VARIABLE:
-      compileIndexes();
+      factor = makeNode(N_VARIABLE, currentToken->lineNo, currentToken->colNo);
+      factor->var.obj = obj;
+      factor->type = typeOfObject(obj);
+      resolveAddress(obj, &factor->var.addr);
+      factor->var.indexes = compileIndexes(factor);
       break;
     case OBJ_PARAMETER:
+      factor = makeNode(N_VARIABLE, currentToken->lineNo, currentToken->colNo);
+      factor->var.obj = obj;
+      factor->type = typeOfObject(obj);
+      resolveAddress(obj, &factor->var.addr);
       break;
     case OBJ_FUNCTION:
-      compileArguments();
+      factor = makeNode(N_FUNCTION_CALL, currentToken->lineNo, currentToken->colNo);
+      factor->call.obj = obj;
+      factor->type = typeOfObject(obj);
+      factor->call.args = compileArguments();
+      checkArguments(factor);
       break;
-    default: 
+    default:
       error(ERR_INVALID_FACTOR,currentToken->lineNo, currentToken->colNo);
       break;
     }
@@ -700,33 +973,99 @@ void compileFactor(void) {
   default:
     error(ERR_INVALID_FACTOR, lookAhead->lineNo, lookAhead->colNo);
   }
+  return factor;
 }
 
-void compileIndexes(void) {
+// The indexes of var, each of which takes its type one level down
+NodeList* compileIndexes(Node* var) {
+  NodeList* indexes = NULL;
+  NodeList** tail = &indexes;
+  Node* index;
+
+  TRACE_RULE();
   while (lookAhead->tokenType == SB_LSEL) {
     eat(SB_LSEL);
-    compileExpression();
+    index = compileExpression();
+    checkIndex(var, index);
+    tail = appendNode(tail, index);
     eat(SB_RSEL);
   }
+  return indexes;
 }
 
 int compile(char *fileName) {
+  jmp_buf point;
+  int loaded = 0;
+  int stopped = 0;
+
   if (openInputStream(fileName) == IO_ERROR)
     return IO_ERROR;
 
-  currentToken = NULL;
-  lookAhead = getValidToken();
+  clearErrors();
 
-  initSymTab();
+  if ((parallelThreads > 0) || incremental) {
+    loaded = loadTokenArray();
+    // Lexical errors are reported as the window meets them: scan again
+    if (!loaded) {
+      closeInputStream();
+      openInputStream(fileName);
+    }
+  }
+  if (!loaded) initTokenWindow();
 
-  compileProgram();
+  currentToken = NULL;
+  lookAhead = nextToken();
 
-  printObject(symtab->program,0);
+  initSymTab();
+  initAST();
+
+  TRACE_MARK(depth);
+  if (setjmp(point) == 0) {
+    // Stop here rather than exit, so a session can go on compiling
+    if (incremental) stopPoint = &point;
+    if (tableParse)
+      compileProgramLL();
+    else if (!loaded)
+      compileProgram();
+    else if (!compileProgramParallel()) {
+      // Start over on this thread alone, for the diagnostics of an ordinary run
+      cleanSymTab();
+      freeAST();
+      freeParserStacks();
+      initSymTab();
+      initAST();
+      free(currentToken);
+      free(lookAhead);
+      seekToken(0);
+      currentToken = NULL;
+      lookAhead = nextToken();
+      compileProgram();
+    }
+  } else {
+    TRACE_UNWIND(depth);
+    stopped = 1;
+  }
+  stopPoint = NULL;
+  recoveryPoint = NULL;
+
+  if (stopped || (errorCount() > 0))
+    printErrors();
+  else {
+    printObject(symtab->program,0);
+    if (printTree) printBodies(symtab->program);
+    if ((moduleFile != NULL) && (writeModule(moduleFile, symtab->program) == IO_ERROR))
+      printf("Can\'t write module file!\n");
+  }
 
   cleanSymTab();
+  freeAST();
+  freeBodies();
+  freeParserStacks();
+  freeLLStacks();
 
   free(currentToken);
   free(lookAhead);
+  freeTokenWindow();
   closeInputStream();
   return IO_SUCCESS;
 
@@ -7,52 +7,88 @@
 #define __PARSER_H__
 #include "token.h"
 #include "symtab.h"
+#include "ast.h"
+#include "grammar.h"
+
+// When set, compile() also prints the syntax tree of every body
+extern int printTree;
+
+// When set, only declarations are compiled: the program's statements and
+// the blocks of its functions and procedures are skipped over, leaving
+// just the symbol table with the subprograms' signatures
+extern int skipBodies;
+
+// Tokens the parser may resynchronize on after an error
+#define DECL_KEYWORDS (TOKEN_BIT(KW_CONST) | TOKEN_BIT(KW_TYPE) | TOKEN_BIT(KW_VAR) | \
+		       TOKEN_BIT(KW_FUNCTION) | TOKEN_BIT(KW_PROCEDURE))
+#define STATEMENT_START (TOKEN_BIT(KW_BEGIN) | TOKEN_BIT(KW_IF) | TOKEN_BIT(KW_WHILE) | \
+			 TOKEN_BIT(KW_FOR) | TOKEN_BIT(KW_CALL))
+#define STATEMENT_SYNC (TOKEN_BIT(SB_SEMICOLON) | TOKEN_BIT(KW_END) | TOKEN_BIT(KW_ELSE) | \
+			TOKEN_BIT(SB_PERIOD) | TOKEN_BIT(TK_EOF) | STATEMENT_START | DECL_KEYWORDS)
+#define DECL_SYNC (TOKEN_BIT(SB_SEMICOLON) | TOKEN_BIT(KW_BEGIN) | TOKEN_BIT(TK_EOF) | DECL_KEYWORDS)
+#define SUBDECL_SYNC (TOKEN_BIT(KW_FUNCTION) | TOKEN_BIT(KW_PROCEDURE) | TOKEN_BIT(KW_BEGIN) | \
+		      TOKEN_BIT(TK_EOF))
+
+// Set when the last statement was abandoned after an error
+extern _Thread_local int resynced;
+
+void skipTo(TokenSet syncSet);
+int compileWithRecovery(void (*compileFn)(void), TokenSet syncSet);
+void compileDecl(void (*compileFn)(void));
 
 void scan(void);
 void eat(TokenType tokenType);
+Token* peek(int k);
 
 void compileProgram(void);
-void compileBlock(void);
-void compileBlock2(void);
-void compileBlock3(void);
-void compileBlock4(void);
-void compileBlock5(void);
+Node* compileBlock(void);
+Node* compileBlock2(void);
+Node* compileBlock3(void);
+Node* compileBlock4(void);
+Node* compileBlock5(void);
 void compileConstDecls(void);
 void compileConstDecl(void);
 void compileTypeDecls(void);
 void compileTypeDecl(void);
 void compileVarDecls(void);
 void compileVarDecl(void);
+void skipBlock(void);
 void compileSubDecls(void);
 void compileFuncDecl(void);
+Object* compileFuncHeader(void);
 void compileProcDecl(void);
+Object* compileProcHeader(void);
 ConstantValue* compileUnsignedConstant(void);
 ConstantValue* compileConstant(void);
 ConstantValue* compileConstant2(void);
+ConstantValue* compileConstantBinary(int minPrecedence);
 Type* compileType(void);
 Type* compileBasicType(void);
 void compileParams(void);
 void compileParam(void);
-void compileStatements(void);
-void compileStatement(void);
-void compileLValue(void);
-void compileAssignSt(void);
-void compileCallSt(void);
-void compileGroupSt(void);
-void compileIfSt(void);
-void compileElseSt(void);
-void compileWhileSt(void);
-void compileForSt(void);
-void compileArgument(void);
-void compileArguments(void);
-void compileCondition(void);
-void compileExpression(void);
-void compileExpression2(void);
-void compileExpression3(void);
-void compileTerm(void);
-void compileTerm2(void);
-void compileFactor(void);
-void compileIndexes(void);
+NodeList* compileStatements(void);
+Node* compileStatement(void);
+Node* compileStatementBody(void);
+Node* compileLValue(void);
+Node* compileAssignSt(void);
+Node* compileCallSt(void);
+Node* compileGroupSt(void);
+Node* compileIfSt(void);
+Node* compileIfHead(void);
+Node* compileElseSt(void);
+Node* compileWhileSt(void);
+Node* compileWhileHead(void);
+Node* compileForSt(void);
+Node* compileForHead(void);
+Node* compileArgument(void);
+NodeList* compileArguments(void);
+Node* compileCondition(void);
+Node* compileExpression(void);
+Node* compileExpression2(void);
+int binaryPrecedence(TokenType tokenType);
+Node* compileBinary(int minPrecedence);
+Node* compileFactor(void);
+NodeList* compileIndexes(Node* var);
 
 int compile(char *fileName);
 
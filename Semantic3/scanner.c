@@ -6,12 +6,14 @@
 
 #include <stdio.h>
 #include <stdlib.h>
-#include <ctype.h>
+#include <string.h>
+#include <limits.h>
 
 #include "reader.h"
 #include "charcode.h"
 #include "token.h"
 #include "error.h"
+#include "strpool.h"
 #include "scanner.h"
 
 
@@ -19,19 +21,20 @@ extern int lineNo;
 extern int colNo;
 extern int currentChar;
 
-extern CharCode charCodes[];
+// A token to return before scanning on, queued behind an error token
+Token *pendingToken = NULL;
 
 /***************************************************************/
 
 void skipBlank() {
-  while ((currentChar != EOF) && (charCodes[currentChar] == CHAR_SPACE))
+  while ((currentChar != EOF) && (charInfo[currentChar].code == CHAR_SPACE))
     readChar();
 }
 
-void skipComment() {
+int skipComment() {
   int state = 0;
   while ((currentChar != EOF) && (state < 2)) {
-    switch (charCodes[currentChar]) {
+    switch (charInfo[currentChar].code) {
     case CHAR_TIMES:
       state = 1;
       break;
@@ -44,30 +47,60 @@ void skipComment() {
     }
     readChar();
   }
-  if (state != 2) 
-    error(ERR_END_OF_COMMENT, lineNo, colNo);
+  return (state == 2);
+}
+
+// Scratch buffer for lexemes that outgrow the token's inline buffer
+char *longLexeme = NULL;
+int longLexemeSize = 0;
+
+void putLexemeChar(Token *token, int count, char ch) {
+  if (count < MAX_INLINE_LEN) {
+    token->buf[count] = ch;
+    return;
+  }
+
+  if (count + 1 >= longLexemeSize) {
+    longLexemeSize = (longLexemeSize == 0) ? 64 : longLexemeSize * 2;
+    longLexeme = (char*) realloc(longLexeme, longLexemeSize);
+  }
+  if (count == MAX_INLINE_LEN)
+    memcpy(longLexeme, token->buf, MAX_INLINE_LEN);
+  longLexeme[count] = ch;
+}
+
+void endLexeme(Token *token, int count) {
+  if (count <= MAX_INLINE_LEN)
+    token->buf[count] = '\0';
+  else token->string = internString(longLexeme, count);
+}
+
+// Lexical errors are returned as TK_NONE tokens carrying the error code, so
+// that a scanner running ahead of the parser reports them in source order
+Token* makeErrorToken(ErrorCode err, int ln, int cn) {
+  Token *token = makeToken(TK_NONE, ln, cn);
+  token->value = err;
+  return token;
 }
 
 Token* readIdentKeyword(void) {
   Token *token = makeToken(TK_NONE, lineNo, colNo);
   int count = 1;
 
-  token->string[0] = toupper((char)currentChar);
+  token->buf[0] = charInfo[currentChar].folded;
   readChar();
 
-  while ((currentChar != EOF) && 
-	 ((charCodes[currentChar] == CHAR_LETTER) || (charCodes[currentChar] == CHAR_DIGIT))) {
-    if (count <= MAX_IDENT_LEN) token->string[count++] = toupper((char)currentChar);
+  // EOF is the only non-byte value; it is never an identifier character
+  while ((currentChar != EOF) && charInfo[currentChar].isIdent) {
+    putLexemeChar(token, count++, charInfo[currentChar].folded);
     readChar();
   }
 
-  if (count > MAX_IDENT_LEN) {
-    error(ERR_IDENT_TOO_LONG, token->lineNo, token->colNo);
-    return token;
-  }
+  endLexeme(token, count);
 
-  token->string[count] = '\0';
-  token->tokenType = checkKeyword(token->string);
+  // Keywords are short, so long lexemes are always identifiers
+  if (count <= MAX_INLINE_LEN)
+    token->tokenType = checkKeyword(token->string);
 
   if (token->tokenType == TK_NONE)
     token->tokenType = TK_IDENT;
@@ -75,17 +108,29 @@ Token* readIdentKeyword(void) {
   return token;
 }
 
+// A literal above INT_MAX is reported at its position and read as INT_MAX
 Token* readNumber(void) {
   Token *token = makeToken(TK_NUMBER, lineNo, colNo);
   int count = 0;
-
-  while ((currentChar != EOF) && (charCodes[currentChar] == CHAR_DIGIT)) {
-    token->string[count++] = (char)currentChar;
+  int digit;
+  int overflow = 0;
+
+  token->value = 0;
+  while ((currentChar != EOF) && (charInfo[currentChar].code == CHAR_DIGIT)) {
+    putLexemeChar(token, count++, (char)currentChar);
+    digit = currentChar - '0';
+    if (token->value > (INT_MAX - digit) / 10) {
+      overflow = 1;
+      token->value = INT_MAX;
+    } else token->value = token->value * 10 + digit;
     readChar();
   }
 
-  token->string[count] = '\0';
-  token->value = atoi(token->string);
+  endLexeme(token, count);
+  if (overflow) {
+    pendingToken = token;
+    return makeErrorToken(ERR_CONSTANT_OVERFLOW, token->lineNo, token->colNo);
+  }
   return token;
 }
 
@@ -95,7 +140,7 @@ Token* readConstChar(void) {
   readChar();
   if (currentChar == EOF) {
     token->tokenType = TK_NONE;
-    error(ERR_INVALID_CONSTANT_CHAR, token->lineNo, token->colNo);
+    token->value = ERR_INVALID_CONSTANT_CHAR;
     return token;
   }
     
@@ -105,16 +150,16 @@ Token* readConstChar(void) {
   readChar();
   if (currentChar == EOF) {
     token->tokenType = TK_NONE;
-    error(ERR_INVALID_CONSTANT_CHAR, token->lineNo, token->colNo);
+    token->value = ERR_INVALID_CONSTANT_CHAR;
     return token;
   }
 
-  if (charCodes[currentChar] == CHAR_SINGLEQUOTE) {
+  if (charInfo[currentChar].code == CHAR_SINGLEQUOTE) {
     readChar();
     return token;
   } else {
     token->tokenType = TK_NONE;
-    error(ERR_INVALID_CONSTANT_CHAR, token->lineNo, token->colNo);
+    token->value = ERR_INVALID_CONSTANT_CHAR;
     return token;
   }
 }
@@ -123,120 +168,134 @@ Token* getToken(void) {
   Token *token;
   int ln, cn;
 
-  if (currentChar == EOF) 
-    return makeToken(TK_EOF, lineNo, colNo);
-
-  switch (charCodes[currentChar]) {
-  case CHAR_SPACE: skipBlank(); return getToken();
-  case CHAR_LETTER: return readIdentKeyword();
-  case CHAR_DIGIT: return readNumber();
-  case CHAR_PLUS: 
-    token = makeToken(SB_PLUS, lineNo, colNo);
-    readChar(); 
-    return token;
-  case CHAR_MINUS:
-    token = makeToken(SB_MINUS, lineNo, colNo);
-    readChar(); 
-    return token;
-  case CHAR_TIMES:
-    token = makeToken(SB_TIMES, lineNo, colNo);
-    readChar(); 
+  if (pendingToken != NULL) {
+    token = pendingToken;
+    pendingToken = NULL;
     return token;
-  case CHAR_SLASH:
-    token = makeToken(SB_SLASH, lineNo, colNo);
-    readChar(); 
-    return token;
-  case CHAR_LT:
-    ln = lineNo;
-    cn = colNo;
-    readChar();
-    if ((currentChar != EOF) && (charCodes[currentChar] == CHAR_EQ)) {
-      readChar();
-      return makeToken(SB_LE, ln, cn);
-    } else return makeToken(SB_LT, ln, cn);
-  case CHAR_GT:
-    ln = lineNo;
-    cn = colNo;
-    readChar();
-    if ((currentChar != EOF) && (charCodes[currentChar] == CHAR_EQ)) {
+  }
+
+  // Blanks and comments produce no token: loop instead of recursing so
+  // long runs of them do not grow the C stack
+  for (;;) {
+    if (currentChar == EOF) 
+      return makeToken(TK_EOF, lineNo, colNo);
+
+    switch (charInfo[currentChar].code) {
+    case CHAR_SPACE: skipBlank(); continue;
+    case CHAR_LETTER: return readIdentKeyword();
+    case CHAR_DIGIT: return readNumber();
+    case CHAR_PLUS: 
+      token = makeToken(SB_PLUS, lineNo, colNo);
+      readChar(); 
+      return token;
+    case CHAR_MINUS:
+      token = makeToken(SB_MINUS, lineNo, colNo);
+      readChar(); 
+      return token;
+    case CHAR_TIMES:
+      token = makeToken(SB_TIMES, lineNo, colNo);
+      readChar(); 
+      return token;
+    case CHAR_SLASH:
+      token = makeToken(SB_SLASH, lineNo, colNo);
+      readChar(); 
+      return token;
+    case CHAR_LT:
+      ln = lineNo;
+      cn = colNo;
       readChar();
-      return makeToken(SB_GE, ln, cn);
-    } else return makeToken(SB_GT, ln, cn);
-  case CHAR_EQ: 
-    token = makeToken(SB_EQ, lineNo, colNo);
-    readChar(); 
-    return token;
-  case CHAR_EXCLAIMATION:
-    ln = lineNo;
-    cn = colNo;
-    readChar();
-    if ((currentChar != EOF) && (charCodes[currentChar] == CHAR_EQ)) {
+      if ((currentChar != EOF) && (charInfo[currentChar].code == CHAR_EQ)) {
+        readChar();
+        return makeToken(SB_LE, ln, cn);
+      } else return makeToken(SB_LT, ln, cn);
+    case CHAR_GT:
+      ln = lineNo;
+      cn = colNo;
       readChar();
-      return makeToken(SB_NEQ, ln, cn);
-    } else {
-      token = makeToken(TK_NONE, ln, cn);
-      error(ERR_INVALID_SYMBOL, ln, cn);
+      if ((currentChar != EOF) && (charInfo[currentChar].code == CHAR_EQ)) {
+        readChar();
+        return makeToken(SB_GE, ln, cn);
+      } else return makeToken(SB_GT, ln, cn);
+    case CHAR_EQ: 
+      token = makeToken(SB_EQ, lineNo, colNo);
+      readChar(); 
       return token;
-    }
-  case CHAR_COMMA:
-    token = makeToken(SB_COMMA, lineNo, colNo);
-    readChar(); 
-    return token;
-  case CHAR_PERIOD:
-    ln = lineNo;
-    cn = colNo;
-    readChar();
-    if ((currentChar != EOF) && (charCodes[currentChar] == CHAR_RPAR)) {
-      readChar();
-      return makeToken(SB_RSEL, ln, cn);
-    } else return makeToken(SB_PERIOD, ln, cn);
-  case CHAR_SEMICOLON:
-    token = makeToken(SB_SEMICOLON, lineNo, colNo);
-    readChar(); 
-    return token;
-  case CHAR_COLON:
-    ln = lineNo;
-    cn = colNo;
-    readChar();
-    if ((currentChar != EOF) && (charCodes[currentChar] == CHAR_EQ)) {
+    case CHAR_EXCLAIMATION:
+      ln = lineNo;
+      cn = colNo;
       readChar();
-      return makeToken(SB_ASSIGN, ln, cn);
-    } else return makeToken(SB_COLON, ln, cn);
-  case CHAR_SINGLEQUOTE: return readConstChar();
-  case CHAR_LPAR:
-    ln = lineNo;
-    cn = colNo;
-    readChar();
-
-    if (currentChar == EOF) 
-      return makeToken(SB_LPAR, ln, cn);
-
-    switch (charCodes[currentChar]) {
+      if ((currentChar != EOF) && (charInfo[currentChar].code == CHAR_EQ)) {
+        readChar();
+        return makeToken(SB_NEQ, ln, cn);
+      } else {
+        return makeErrorToken(ERR_INVALID_SYMBOL, ln, cn);
+      }
+    case CHAR_COMMA:
+      token = makeToken(SB_COMMA, lineNo, colNo);
+      readChar(); 
+      return token;
     case CHAR_PERIOD:
+      ln = lineNo;
+      cn = colNo;
       readChar();
-      return makeToken(SB_LSEL, ln, cn);
-    case CHAR_TIMES:
+      if ((currentChar != EOF) && (charInfo[currentChar].code == CHAR_RPAR)) {
+        readChar();
+        return makeToken(SB_RSEL, ln, cn);
+      } else return makeToken(SB_PERIOD, ln, cn);
+    case CHAR_SEMICOLON:
+      token = makeToken(SB_SEMICOLON, lineNo, colNo);
+      readChar(); 
+      return token;
+    case CHAR_COLON:
+      ln = lineNo;
+      cn = colNo;
       readChar();
-      skipComment();
-      return getToken();
+      if ((currentChar != EOF) && (charInfo[currentChar].code == CHAR_EQ)) {
+        readChar();
+        return makeToken(SB_ASSIGN, ln, cn);
+      } else return makeToken(SB_COLON, ln, cn);
+    case CHAR_SINGLEQUOTE: return readConstChar();
+    case CHAR_LPAR:
+      ln = lineNo;
+      cn = colNo;
+      readChar();
+
+      if (currentChar == EOF) 
+        return makeToken(SB_LPAR, ln, cn);
+
+      switch (charInfo[currentChar].code) {
+      case CHAR_PERIOD:
+        readChar();
+        return makeToken(SB_LSEL, ln, cn);
+      case CHAR_TIMES:
+        readChar();
+        if (skipComment()) continue;
+        return makeErrorToken(ERR_END_OF_COMMENT, lineNo, colNo);
+      default:
+        return makeToken(SB_LPAR, ln, cn);
+      }
+    case CHAR_RPAR:
+      token = makeToken(SB_RPAR, lineNo, colNo);
+      readChar(); 
+      return token;
     default:
-      return makeToken(SB_LPAR, ln, cn);
+      token = makeErrorToken(ERR_INVALID_SYMBOL, lineNo, colNo);
+      readChar(); 
+      return token;
     }
-  case CHAR_RPAR:
-    token = makeToken(SB_RPAR, lineNo, colNo);
-    readChar(); 
-    return token;
-  default:
-    token = makeToken(TK_NONE, lineNo, colNo);
-    error(ERR_INVALID_SYMBOL, lineNo, colNo);
-    readChar(); 
-    return token;
   }
 }
 
+// Drop a token left queued by a scan that stopped early
+void discardPendingToken(void) {
+  free(pendingToken);
+  pendingToken = NULL;
+}
+
 Token* getValidToken(void) {
   Token *token = getToken();
   while (token->tokenType == TK_NONE) {
+    reportError(token->value, token->lineNo, token->colNo);
     free(token);
     token = getToken();
   }
@@ -11,6 +11,7 @@
 
 Token* getToken(void);
 Token* getValidToken(void);
+void discardPendingToken(void);
 void printToken(Token *token);
 
 #endif
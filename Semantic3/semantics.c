@@ -6,20 +6,30 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include <limits.h>
 #include "debug.h"
 #include "semantics.h"
 #include "error.h"
+#include "idtable.h"
 
-extern SymTab* symtab;
-extern Token* currentToken;
+extern _Thread_local SymTab* symtab;
+extern _Thread_local Token* currentToken;
 
 Object* lookupObject(char *name) {
-  Scope* scope = symtab->currentScope;
+  unsigned hash = hashName(name);
+  Scope* scope;
+  ObjectNode* node;
   Object* obj;
 
-  while (scope != NULL) {
-    obj = findObject(scope->objList, name);
-    if (obj != NULL) return obj;
+  obj = findIdent(name, hash);
+  if (obj != NULL) return obj;
+
+  // The scopes around those entered on this thread
+  for (scope = outsideScope(); scope != NULL; ) {
+    node = findScopeNode(scope, name, hash);
+    // Past snapshotLast, objects of the snapshot scope are not visible yet
+    if ((node != NULL) && ((scope != snapshotScope) || (node->index <= snapshotLast->index)))
+      return node->object;
     scope = scope->outer;
   }
   obj = findObject(symtab->globalObjectList, name);
@@ -28,7 +38,7 @@ Object* lookupObject(char *name) {
 }
 
 void checkFreshIdent(char *name) {
-  if (findObject(symtab->currentScope->objList, name) != NULL)
+  if (findScopeObject(symtab->currentScope, name) != NULL)
     error(ERR_DUPLICATE_IDENT, currentToken->lineNo, currentToken->colNo);
 }
 
@@ -107,7 +117,7 @@ Object* checkDeclaredLValueIdent(char* name) {
     break;
   case OBJ_FUNCTION:
     // scope = symtab->currentScope;
-    // while ((scope != NULL) && (scope != obj->funcAttrs->scope)) 
+    // while ((scope != NULL) && (scope != obj->funcAttrs.scope)) 
     //   scope = scope->outer;
     // if (scope == NULL)
     //   error(ERR_INVALID_IDENT,currentToken->lineNo, currentToken->colNo);
@@ -122,3 +132,204 @@ Object* checkDeclaredLValueIdent(char* name) {
   return obj;
 }
 
+// The address of a variable, parameter or function result used in the
+// current scope
+void resolveAddress(Object* obj, Address* addr) {
+  Scope* scope;
+
+  switch (obj->kind) {
+  case OBJ_VARIABLE:
+    scope = obj->varAttrs.scope;
+    addr->offset = obj->varAttrs.localOffset;
+    break;
+  case OBJ_PARAMETER:
+    if (obj->paramAttrs.function->kind == OBJ_FUNCTION)
+      scope = obj->paramAttrs.function->funcAttrs.scope;
+    else scope = obj->paramAttrs.function->procAttrs.scope;
+    addr->offset = obj->paramAttrs.localOffset;
+    break;
+  case OBJ_FUNCTION:
+    scope = obj->funcAttrs.scope;
+    addr->offset = RETURN_VALUE_OFFSET;
+    break;
+  default:
+    return;
+  }
+  addr->depth = symtab->currentScope->level - scope->level;
+}
+
+/******************* Types ******************************/
+
+// Each expression node records its type as it is built. Types are
+// canonical, so equal types are the same object. Errors are reported at
+// the current token.
+
+void checkIntType(Type* type) {
+  if ((type == NULL) || (type->typeClass != TP_INT))
+    error(ERR_TYPE_INCONSISTENCY, currentToken->lineNo, currentToken->colNo);
+}
+
+void checkBasicType(Type* type) {
+  if ((type == NULL) || (type->typeClass == TP_ARRAY))
+    error(ERR_TYPE_INCONSISTENCY, currentToken->lineNo, currentToken->colNo);
+}
+
+void checkArrayType(Type* type) {
+  if ((type == NULL) || (type->typeClass != TP_ARRAY))
+    error(ERR_TYPE_INCONSISTENCY, currentToken->lineNo, currentToken->colNo);
+}
+
+void checkTypeEquality(Type* type1, Type* type2) {
+  if (type1 != type2)
+    error(ERR_TYPE_INCONSISTENCY, currentToken->lineNo, currentToken->colNo);
+}
+
+// The type of an expression naming obj, before any index
+Type* typeOfObject(Object* obj) {
+  switch (obj->kind) {
+  case OBJ_CONSTANT:
+    return (obj->constAttrs.value->type == TP_INT) ? makeIntType() : makeCharType();
+  case OBJ_VARIABLE:
+    return obj->varAttrs.type;
+  case OBJ_PARAMETER:
+    return obj->paramAttrs.type;
+  case OBJ_FUNCTION:
+    return obj->funcAttrs.returnType;
+  default:
+    return NULL;
+  }
+}
+
+// Apply one more index to var
+void checkIndex(Node* var, Node* index) {
+  checkArrayType(var->type);
+  checkIntType(index->type);
+  var->type = var->type->elementType;
+}
+
+// The arguments of a complete call against the callee's parameters. A VAR
+// parameter takes a variable.
+void checkArguments(Node* call) {
+  ObjectNode* param;
+  NodeList* arg = call->call.args;
+
+  if (call->call.obj->kind == OBJ_FUNCTION)
+    param = call->call.obj->funcAttrs.paramList;
+  else param = call->call.obj->procAttrs.paramList;
+
+  for (; (param != NULL) && (arg != NULL); param = param->next, arg = arg->next) {
+    if ((param->object->paramAttrs.kind == PARAM_REFERENCE) && (arg->node->kind != N_VARIABLE))
+      error(ERR_PARAMETERS_ARGUMENTS_INCONSISTENCY, currentToken->lineNo, currentToken->colNo);
+    checkTypeEquality(param->object->paramAttrs.type, arg->node->type);
+  }
+  if ((param != NULL) || (arg != NULL))
+    error(ERR_PARAMETERS_ARGUMENTS_INCONSISTENCY, currentToken->lineNo, currentToken->colNo);
+}
+
+/******************* Constants ******************************/
+
+// Constant declarations and array sizes are evaluated as they are parsed,
+// and arithmetic on constant operands in statements is replaced by its
+// value. Errors are reported at the current token.
+
+// The value of left op right, which must fit an INTEGER
+int foldOperation(TokenType op, int left, int right) {
+  long long value;
+
+  switch (op) {
+  case SB_PLUS:
+    value = (long long) left + right;
+    break;
+  case SB_MINUS:
+    value = (long long) left - right;
+    break;
+  case SB_TIMES:
+    value = (long long) left * right;
+    break;
+  default:
+    if (right == 0)
+      error(ERR_DIVISION_BY_ZERO, currentToken->lineNo, currentToken->colNo);
+    value = (long long) left / right;
+    break;
+  }
+  if ((value < INT_MIN) || (value > INT_MAX))
+    error(ERR_CONSTANT_OVERFLOW, currentToken->lineNo, currentToken->colNo);
+  return (int) value;
+}
+
+void checkIntConstant(ConstantValue* value) {
+  if (value->type != TP_INT)
+    error(ERR_TYPE_INCONSISTENCY, currentToken->lineNo, currentToken->colNo);
+}
+
+// Combine right into left, a value of its own
+void foldConstant(TokenType op, ConstantValue* left, ConstantValue* right) {
+  checkIntConstant(left);
+  checkIntConstant(right);
+  left->intValue = foldOperation(op, left->intValue, right->intValue);
+}
+
+void negateConstant(ConstantValue* value) {
+  checkIntConstant(value);
+  value->intValue = foldOperation(SB_MINUS, 0, value->intValue);
+}
+
+int checkArraySize(ConstantValue* size) {
+  checkIntConstant(size);
+  if (size->intValue < 0)
+    error(ERR_INVALID_ARRAY_SIZE, currentToken->lineNo, currentToken->colNo);
+  return size->intValue;
+}
+
+// Addresses are INTEGERs, so an array and a frame hold at most INT_MAX
+// words. Types that pass give sizeOfType() no overflow.
+void checkArrayWords(int arraySize, Type* elementType) {
+  if ((long long) arraySize * sizeOfType(elementType) > INT_MAX)
+    error(ERR_INVALID_ARRAY_SIZE, currentToken->lineNo, currentToken->colNo);
+}
+
+// Room for a variable of type at the end of the current frame
+void checkFrameSpace(Type* type) {
+  if ((long long) symtab->currentScope->frameSize + sizeOfType(type) > INT_MAX)
+    error(ERR_FRAME_TOO_LARGE, currentToken->lineNo, currentToken->colNo);
+}
+
+// Whether expr is an integer known at compile time, and its value
+int isIntConstant(Node* expr, int* value) {
+  switch (expr->kind) {
+  case N_NUMBER:
+    *value = expr->value;
+    return 1;
+  case N_CONSTANT:
+    if (expr->var.obj->constAttrs.value->type != TP_INT) return 0;
+    *value = expr->var.obj->constAttrs.value->intValue;
+    return 1;
+  default:
+    return 0;
+  }
+}
+
+// Turn a complete binary expression on two constants into a number. A
+// constant divisor of zero is an error whatever the dividend.
+void foldBinary(Node* expr) {
+  int left, right, value;
+
+  if (!isIntConstant(expr->binary.right, &right)) return;
+  if ((expr->binary.op == SB_SLASH) && (right == 0))
+    error(ERR_DIVISION_BY_ZERO, currentToken->lineNo, currentToken->colNo);
+  if (!isIntConstant(expr->binary.left, &left)) return;
+
+  value = foldOperation(expr->binary.op, left, right);
+  expr->kind = N_NUMBER;
+  expr->value = value;
+}
+
+void foldUnary(Node* expr) {
+  int operand, value;
+
+  if (!isIntConstant(expr->unary.operand, &operand)) return;
+
+  value = foldOperation(SB_MINUS, 0, operand);
+  expr->kind = N_NUMBER;
+  expr->value = value;
+}
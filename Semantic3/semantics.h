@@ -8,6 +8,7 @@
 #define __SEMANTICS_H__
 
 #include "symtab.h"
+#include "ast.h"
 
 void checkFreshIdent(char *name);
 Object* checkDeclaredIdent(char *name);
@@ -18,4 +19,26 @@ Object* checkDeclaredFunction(char *name);
 Object* checkDeclaredProcedure(char *name);
 Object* checkDeclaredLValueIdent(char *name);
 
+void resolveAddress(Object* obj, Address* addr);
+
+void checkIntType(Type* type);
+void checkBasicType(Type* type);
+void checkArrayType(Type* type);
+void checkTypeEquality(Type* type1, Type* type2);
+
+Type* typeOfObject(Object* obj);
+void checkIndex(Node* var, Node* index);
+void checkArguments(Node* call);
+
+int foldOperation(TokenType op, int left, int right);
+void checkIntConstant(ConstantValue* value);
+void foldConstant(TokenType op, ConstantValue* left, ConstantValue* right);
+void negateConstant(ConstantValue* value);
+int checkArraySize(ConstantValue* size);
+void checkArrayWords(int arraySize, Type* elementType);
+void checkFrameSpace(Type* type);
+int isIntConstant(Node* expr, int* value);
+void foldBinary(Node* expr);
+void foldUnary(Node* expr);
+
 #endif
@@ -0,0 +1,290 @@
+/*
+ * @copyright (c) 2026
+ * @author agent <agent@local>
+ * @version 1.0
+ */
+
+#include <stdlib.h>
+
+#include "parser.h"
+#include "stackparser.h"
+#include "semantics.h"
+#include "error.h"
+#include "trace.h"
+#include "parallel.h"
+
+extern _Thread_local Token *currentToken;
+extern _Thread_local Token *lookAhead;
+extern _Thread_local SymTab* symtab;
+
+int stackParse = 0;
+
+#define INITIAL_STACK_SIZE 64
+
+/******************* Block stack ******************************/
+
+// A subprogram whose declaration is being parsed. The bottom frame stands
+// for the block compileBlockIterative() was called for.
+struct BlockFrame {
+  Object* owner;
+  Scope* outerScope;    // restored when the declaration is abandoned
+  int inSubDecls;       // its constant, type and variable parts are done
+};
+
+_Thread_local struct BlockFrame* blockStack = NULL;
+_Thread_local int blockTop = 0;
+_Thread_local int blockStackSize = 0;
+
+// The scope a subprogram header is being parsed in, NULL between headers
+_Thread_local Scope* headerScope = NULL;
+
+void pushBlock(Object* owner, Scope* outerScope) {
+  if (blockTop == blockStackSize) {
+    blockStackSize = (blockStackSize == 0) ? INITIAL_STACK_SIZE : 2 * blockStackSize;
+    blockStack = (struct BlockFrame*) realloc(blockStack, blockStackSize * sizeof(struct BlockFrame));
+  }
+  blockStack[blockTop].owner = owner;
+  blockStack[blockTop].outerScope = outerScope;
+  blockStack[blockTop].inSubDecls = 0;
+  blockTop ++;
+}
+
+void setBody(Object* owner, Node* body) {
+  if (owner->kind == OBJ_FUNCTION)
+    owner->funcAttrs.body = body;
+  else owner->procAttrs.body = body;
+}
+
+// Same language and recovery as compileBlock(), but a nested function or
+// procedure pushes a frame instead of recursing
+Node* compileBlockIterative(void) {
+  jmp_buf point;
+  jmp_buf *outer = recoveryPoint;
+  int base = blockTop;
+  struct BlockFrame* frame;
+  Object* owner;
+  Node* body;
+
+  TRACE_RULE();
+  TRACE_MARK(depth);
+  pushBlock(NULL, symtab->currentScope);
+
+  if (setjmp(point) != 0) {
+    TRACE_UNWIND(depth);
+    if ((headerScope == NULL) && (blockTop == base + 1)) {
+      // Not inside any subprogram declaration: the caller recovers
+      blockTop = base;
+      recoveryPoint = outer;
+      recover();
+    }
+    // Abandon the innermost subprogram declaration, as compileSubDecls()
+    // does through compileWithRecovery()
+    if (headerScope != NULL) {
+      restoreBlock(headerScope);
+      headerScope = NULL;
+    } else {
+      blockTop --;
+      restoreBlock(blockStack[blockTop].outerScope);
+    }
+    skipTo(SUBDECL_SYNC);
+  }
+  recoveryPoint = &point;
+
+  for (;;) {
+    frame = &blockStack[blockTop - 1];
+    if (!frame->inSubDecls) {
+      compileConstDecls();
+      compileTypeDecls();
+      compileVarDecls();
+      frame->inSubDecls = 1;
+    }
+
+    if ((lookAhead->tokenType == KW_FUNCTION) || (lookAhead->tokenType == KW_PROCEDURE)) {
+      if (deferSubDecl()) continue;
+      headerScope = symtab->currentScope;
+      if (lookAhead->tokenType == KW_FUNCTION)
+	owner = compileFuncHeader();
+      else owner = compileProcHeader();
+      pushBlock(owner, headerScope);
+      headerScope = NULL;
+      continue;
+    }
+
+    startBodies();
+    body = compileBlock5Iterative();
+    if (blockTop == base + 1) break;
+
+    frame = &blockStack[blockTop - 1];
+    setBody(frame->owner, body);
+    eat(SB_SEMICOLON);
+    exitBlock();
+    blockTop --;
+  }
+
+  blockTop = base;
+  recoveryPoint = outer;
+  return body;
+}
+
+Node* compileBlock5Iterative(void) {
+  Node* body = makeNode(N_GROUP, lookAhead->lineNo, lookAhead->colNo);
+
+  TRACE_RULE();
+  eat(KW_BEGIN);
+  compileStatementsIterative(body);
+  eat(KW_END);
+  return body;
+}
+
+/******************* Statement stack ******************************/
+
+enum StatementState {
+  ST_LIST,      // the statements of the block body
+  ST_GROUP,     // the statements between BEGIN and END
+  ST_THEN,
+  ST_ELSE,
+  ST_BODY       // the body of a while or for loop
+};
+
+// A compound statement whose inner statements are being parsed
+struct StatementFrame {
+  enum StatementState state;
+  Node* node;
+  NodeList** tail;
+};
+
+_Thread_local struct StatementFrame* statementStack = NULL;
+_Thread_local int statementTop = 0;
+_Thread_local int statementStackSize = 0;
+
+// Set while the END of the innermost BEGIN ... END is being eaten
+_Thread_local int closingGroup = 0;
+
+void pushStatement(enum StatementState state, Node* node, NodeList** tail) {
+  if (statementTop == statementStackSize) {
+    statementStackSize = (statementStackSize == 0) ? INITIAL_STACK_SIZE : 2 * statementStackSize;
+    statementStack = (struct StatementFrame*) realloc(statementStack, statementStackSize * sizeof(struct StatementFrame));
+  }
+  statementStack[statementTop].state = state;
+  statementStack[statementTop].node = node;
+  statementStack[statementTop].tail = tail;
+  statementTop ++;
+}
+
+// Parse a simple statement, or the head of a compound one and push its
+// frame. Returns NULL in the latter case.
+Node* startStatement(void) {
+  Node* stmt;
+
+  switch (lookAhead->tokenType) {
+  case KW_BEGIN:
+    stmt = makeNode(N_GROUP, lookAhead->lineNo, lookAhead->colNo);
+    eat(KW_BEGIN);
+    pushStatement(ST_GROUP, stmt, &stmt->group.stmts);
+    return NULL;
+  case KW_IF:
+    pushStatement(ST_THEN, compileIfHead(), NULL);
+    return NULL;
+  case KW_WHILE:
+    pushStatement(ST_BODY, compileWhileHead(), NULL);
+    return NULL;
+  case KW_FOR:
+    pushStatement(ST_BODY, compileForHead(), NULL);
+    return NULL;
+  default:
+    stmt = compileStatementBody();
+    resynced = 0;
+    return stmt;
+  }
+}
+
+// Parse the statements of a block body into group, with the same
+// recovery as compileStatements(): an error abandons the innermost
+// statement being parsed, which becomes an empty one
+void compileStatementsIterative(Node* group) {
+  jmp_buf point;
+  jmp_buf *outer = recoveryPoint;
+  int base = statementTop;
+  struct StatementFrame* frame;
+  Node* stmt;
+
+  TRACE_RULE();
+  TRACE_MARK(depth);
+  pushStatement(ST_LIST, group, &group->group.stmts);
+
+  if (setjmp(point) == 0)
+    stmt = NULL;
+  else {
+    TRACE_UNWIND(depth);
+    if (closingGroup) {
+      statementTop --;
+      closingGroup = 0;
+    }
+    skipTo(STATEMENT_SYNC);
+    stmt = makeNode(N_EMPTY, lookAhead->lineNo, lookAhead->colNo);
+    resynced = 1;
+  }
+  recoveryPoint = &point;
+
+  for (;;) {
+    while (stmt == NULL)
+      stmt = startStatement();
+
+    // Hand the complete statement to the innermost open one
+    frame = &statementStack[statementTop - 1];
+    switch (frame->state) {
+    case ST_LIST:
+    case ST_GROUP:
+      frame->tail = appendNode(frame->tail, stmt);
+      stmt = NULL;
+      if (lookAhead->tokenType == SB_SEMICOLON) {
+	eat(SB_SEMICOLON);
+	continue;
+      }
+      if (resynced && IN_SET(STATEMENT_START, lookAhead->tokenType))
+	continue;
+      if (frame->state == ST_LIST) {
+	statementTop = base;
+	recoveryPoint = outer;
+	return;
+      }
+      closingGroup = 1;
+      eat(KW_END);
+      closingGroup = 0;
+      break;
+    case ST_THEN:
+      frame->node->ifSt.thenSt = stmt;
+      stmt = NULL;
+      if (lookAhead->tokenType == KW_ELSE) {
+	eat(KW_ELSE);
+	frame->state = ST_ELSE;
+	continue;
+      }
+      break;
+    case ST_ELSE:
+      frame->node->ifSt.elseSt = stmt;
+      break;
+    case ST_BODY:
+      if (frame->node->kind == N_WHILE)
+	frame->node->whileSt.body = stmt;
+      else frame->node->forSt.body = stmt;
+      break;
+    }
+
+    // The innermost open statement is complete
+    stmt = frame->node;
+    statementTop --;
+    resynced = 0;
+  }
+}
+
+void freeParserStacks(void) {
+  free(blockStack);
+  free(statementStack);
+  blockStack = NULL;
+  statementStack = NULL;
+  blockStackSize = statementStackSize = 0;
+  blockTop = statementTop = 0;
+  headerScope = NULL;
+  closingGroup = 0;
+}
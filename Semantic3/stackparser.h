@@ -0,0 +1,24 @@
+/*
+ * @copyright (c) 2026
+ * @author agent <agent@local>
+ * @version 1.0
+ */
+
+#ifndef __STACKPARSER_H__
+#define __STACKPARSER_H__
+
+#include "ast.h"
+#include "symtab.h"
+
+// When set, blocks and statements are parsed by loops over explicit heap
+// stacks instead of recursive descent, so nesting depth is bounded by
+// memory rather than by the C stack
+extern int stackParse;
+
+void setBody(Object* owner, Node* body);
+Node* compileBlockIterative(void);
+Node* compileBlock5Iterative(void);
+void compileStatementsIterative(Node* group);
+void freeParserStacks(void);
+
+#endif
@@ -0,0 +1,106 @@
+/* 
+ * @copyright (c) 2026
+ * @author agent <agent@local>
+ * @version 1.0
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "strpool.h"
+
+#define INIT_POOL_SIZE 256
+
+struct PoolEntry_ {
+  unsigned hash;
+  int len;
+  struct PoolEntry_ *next;
+  char string[];
+};
+
+typedef struct PoolEntry_ PoolEntry;
+
+PoolEntry** poolBuckets = NULL;
+int poolSize = 0;
+int poolCount = 0;
+
+// The scanner may run on its own thread (see tokenwin.c)
+pthread_mutex_t poolLock = PTHREAD_MUTEX_INITIALIZER;
+
+unsigned hashString(char *s, int len) {
+  unsigned h = 2166136261u;
+  int i;
+  for (i = 0; i < len; i++) {
+    h ^= (unsigned char) s[i];
+    h *= 16777619u;
+  }
+  return h;
+}
+
+void growStringPool(void) {
+  int newSize = poolSize * 2;
+  PoolEntry** newBuckets = (PoolEntry**) calloc(newSize, sizeof(PoolEntry*));
+  int i;
+
+  for (i = 0; i < poolSize; i++) {
+    PoolEntry* e = poolBuckets[i];
+    while (e != NULL) {
+      PoolEntry* next = e->next;
+      e->next = newBuckets[e->hash & (newSize - 1)];
+      newBuckets[e->hash & (newSize - 1)] = e;
+      e = next;
+    }
+  }
+  free(poolBuckets);
+  poolBuckets = newBuckets;
+  poolSize = newSize;
+}
+
+void initStringPool(void) {
+  poolSize = INIT_POOL_SIZE;
+  poolCount = 0;
+  poolBuckets = (PoolEntry**) calloc(poolSize, sizeof(PoolEntry*));
+}
+
+void freeStringPool(void) {
+  int i;
+  for (i = 0; i < poolSize; i++) {
+    PoolEntry* e = poolBuckets[i];
+    while (e != NULL) {
+      PoolEntry* next = e->next;
+      free(e);
+      e = next;
+    }
+  }
+  free(poolBuckets);
+  poolBuckets = NULL;
+  poolSize = 0;
+  poolCount = 0;
+}
+
+char* internString(char *s, int len) {
+  unsigned h = hashString(s, len);
+  PoolEntry* e;
+
+  pthread_mutex_lock(&poolLock);
+  e = poolBuckets[h & (poolSize - 1)];
+  while (e != NULL) {
+    if ((e->hash == h) && (e->len == len) && (memcmp(e->string, s, len) == 0)) {
+      pthread_mutex_unlock(&poolLock);
+      return e->string;
+    }
+    e = e->next;
+  }
+
+  e = (PoolEntry*) malloc(sizeof(PoolEntry) + len + 1);
+  e->hash = h;
+  e->len = len;
+  memcpy(e->string, s, len);
+  e->string[len] = '\0';
+  e->next = poolBuckets[h & (poolSize - 1)];
+  poolBuckets[h & (poolSize - 1)] = e;
+
+  if (++poolCount > poolSize) growStringPool();
+  pthread_mutex_unlock(&poolLock);
+  return e->string;
+}
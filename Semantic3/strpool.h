@@ -0,0 +1,18 @@
+/* 
+ * @copyright (c) 2026
+ * @author agent <agent@local>
+ * @version 1.0
+ */
+
+#ifndef __STRPOOL_H__
+#define __STRPOOL_H__
+
+// Interned storage for lexemes that do not fit inline (see MAX_INLINE_LEN).
+// Equal strings share one copy that lives until freeStringPool().
+
+void initStringPool(void);
+void freeStringPool(void);
+char* internString(char *s, int len);
+unsigned hashString(char *s, int len);
+
+#endif
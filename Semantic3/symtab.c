@@ -5,93 +5,148 @@
  */
 
 #include <stdio.h>
+#include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
+#include <pthread.h>
 #include "symtab.h"
 #include "error.h"
+#include "strpool.h"
+#include "idtable.h"
 
-void freeObject(Object* obj);
-void freeScope(Scope* scope);
-void freeObjectList(ObjectNode *objList);
-void freeReferenceList(ObjectNode *objList);
+void setObjectName(Object* obj, char *name);
+ObjectNode* addObject(Arena* arena, ObjectNode **objList, ObjectNode **last, Object* obj);
 
-SymTab* symtab;
+// A thread parsing a subprogram body works on its own copy, so that its
+// current scope is private
+_Thread_local SymTab* symtab;
+_Thread_local Scope* snapshotScope = NULL;
+_Thread_local ObjectNode* snapshotLast = NULL;
 Type* intType;
 Type* charType;
 
+Arena symtabArena;
+_Thread_local Arena* symArena = &symtabArena;
+
 /******************* Type utilities ******************************/
 
+// Types are hash-consed: equal types are one shared object, so they are
+// compared by pointer and never copied or freed one by one. They live
+// until freeTypes(), across compilations, as cached bodies refer to them.
+
+// Canonical array types by size and element type, open addressing
+Arena typeArena;
+Type** arrayTypes = NULL;
+int arrayTypeCount = 0;
+int arrayTableSize = 0;
+
+// Bodies parsed on the pool declare types too
+pthread_mutex_t typeLock = PTHREAD_MUTEX_INITIALIZER;
+
+void initTypes(void) {
+  initArena(&typeArena);
+  intType = (Type*) arenaAlloc(&typeArena, sizeof(Type));
+  intType->typeClass = TP_INT;
+  intType->arraySize = 0;
+  intType->elementType = NULL;
+  charType = (Type*) arenaAlloc(&typeArena, sizeof(Type));
+  charType->typeClass = TP_CHAR;
+  charType->arraySize = 0;
+  charType->elementType = NULL;
+  arrayTableSize = 64;
+  arrayTypes = (Type**) calloc(arrayTableSize, sizeof(Type*));
+  arrayTypeCount = 0;
+}
+
+void freeTypes(void) {
+  free(arrayTypes);
+  arrayTypes = NULL;
+  arrayTableSize = arrayTypeCount = 0;
+  freeArena(&typeArena);
+}
+
 Type* makeIntType(void) {
-  Type* type = (Type*) malloc(sizeof(Type));
-  type->typeClass = TP_INT;
-  return type;
+  return intType;
 }
 
 Type* makeCharType(void) {
-  Type* type = (Type*) malloc(sizeof(Type));
-  type->typeClass = TP_CHAR;
-  return type;
+  return charType;
 }
 
-Type* makeArrayType(int arraySize, Type* elementType) {
-  Type* type = (Type*) malloc(sizeof(Type));
-  type->typeClass = TP_ARRAY;
-  type->arraySize = arraySize;
-  type->elementType = elementType;
-  return type;
+int arrayTypeSlot(int arraySize, Type* elementType) {
+  uintptr_t h = (((uintptr_t) elementType >> 4) ^ (unsigned) arraySize) * 0x9E3779B97F4A7C15ULL;
+  int i = (int) (h >> 20) & (arrayTableSize - 1);
+  Type* type;
+
+  while (((type = arrayTypes[i]) != NULL) &&
+	 ((type->arraySize != arraySize) || (type->elementType != elementType)))
+    i = (i + 1) & (arrayTableSize - 1);
+  return i;
 }
 
-Type* duplicateType(Type* type) {
-  Type* resultType = (Type*) malloc(sizeof(Type));
-  resultType->typeClass = type->typeClass;
-  if (type->typeClass == TP_ARRAY) {
-    resultType->arraySize = type->arraySize;
-    resultType->elementType = duplicateType(type->elementType);
-  }
-  return resultType;
+void growArrayTypes(void) {
+  Type** old = arrayTypes;
+  int oldSize = arrayTableSize;
+  int i;
+
+  arrayTableSize *= 2;
+  arrayTypes = (Type**) calloc(arrayTableSize, sizeof(Type*));
+  for (i = 0; i < oldSize; i++)
+    if (old[i] != NULL)
+      arrayTypes[arrayTypeSlot(old[i]->arraySize, old[i]->elementType)] = old[i];
+  free(old);
 }
 
-int compareType(Type* type1, Type* type2) {
-  if (type1->typeClass == type2->typeClass) {
-    if (type1->typeClass == TP_ARRAY) {
-      if (type1->arraySize == type2->arraySize)
-	return compareType(type1->elementType, type2->elementType);
-      else return 0;
-    } else return 1;
-  } else return 0;
+Type* makeArrayType(int arraySize, Type* elementType) {
+  Type* type;
+  int i;
+
+  pthread_mutex_lock(&typeLock);
+  i = arrayTypeSlot(arraySize, elementType);
+  if ((type = arrayTypes[i]) == NULL) {
+    type = (Type*) arenaAlloc(&typeArena, sizeof(Type));
+    type->typeClass = TP_ARRAY;
+    type->arraySize = arraySize;
+    type->elementType = elementType;
+    arrayTypes[i] = type;
+    if (2 * (++arrayTypeCount) > arrayTableSize)
+      growArrayTypes();
+  }
+  pthread_mutex_unlock(&typeLock);
+  return type;
 }
 
-void freeType(Type* type) {
+int sizeOfType(Type* type) {
   switch (type->typeClass) {
   case TP_INT:
+    return INT_SIZE;
   case TP_CHAR:
-    free(type);
-    break;
+    return CHAR_SIZE;
   case TP_ARRAY:
-    freeType(type->elementType);
-    freeType(type);
-    break;
+    return type->arraySize * sizeOfType(type->elementType);
   }
+  return 0;
 }
 
 /******************* Constant utility ******************************/
 
 ConstantValue* makeIntConstant(int i) {
-  ConstantValue* value = (ConstantValue*) malloc(sizeof(ConstantValue));
+  ConstantValue* value = (ConstantValue*) arenaAlloc(symArena, sizeof(ConstantValue));
   value->type = TP_INT;
   value->intValue = i;
   return value;
 }
 
 ConstantValue* makeCharConstant(char ch) {
-  ConstantValue* value = (ConstantValue*) malloc(sizeof(ConstantValue));
+  ConstantValue* value = (ConstantValue*) arenaAlloc(symArena, sizeof(ConstantValue));
   value->type = TP_CHAR;
   value->charValue = ch;
   return value;
 }
 
 ConstantValue* duplicateConstantValue(ConstantValue* v) {
-  ConstantValue* value = (ConstantValue*) malloc(sizeof(ConstantValue));
+  ConstantValue* value = (ConstantValue*) arenaAlloc(symArena, sizeof(ConstantValue));
   value->type = v->type;
   if (v->type == TP_INT) 
     value->intValue = v->intValue;
@@ -102,154 +157,194 @@ ConstantValue* duplicateConstantValue(ConstantValue* v) {
 
 /******************* Object utilities ******************************/
 
+// An object is allocated only as far as the attributes of its kind
+#define OBJECT_SIZE(attrs) (offsetof(Object, attrs) + sizeof(((Object*) 0)->attrs))
+
+void setObjectName(Object* obj, char *name) {
+  int len = strlen(name);
+
+  if (len <= MAX_INLINE_LEN) {
+    memcpy(obj->inlineName, name, len + 1);
+    obj->name = obj->inlineName;
+  } else obj->name = internString(name, len);
+}
+
+int objectSize(Object* obj) {
+  switch (obj->kind) {
+  case OBJ_CONSTANT:
+    return OBJECT_SIZE(constAttrs);
+  case OBJ_VARIABLE:
+    return OBJECT_SIZE(varAttrs);
+  case OBJ_TYPE:
+    return OBJECT_SIZE(typeAttrs);
+  case OBJ_FUNCTION:
+    return OBJECT_SIZE(funcAttrs);
+  case OBJ_PROCEDURE:
+    return OBJECT_SIZE(procAttrs);
+  case OBJ_PARAMETER:
+    return OBJECT_SIZE(paramAttrs);
+  default:
+    return OBJECT_SIZE(progAttrs);
+  }
+}
+
 Scope* createScope(Object* owner, Scope* outer) {
-  Scope* scope = (Scope*) malloc(sizeof(Scope));
+  Scope* scope = (Scope*) arenaAlloc(symArena, sizeof(Scope));
   scope->objList = NULL;
+  scope->lastObject = NULL;
+  scope->objectCount = 0;
+  scope->table = NULL;
+  scope->tableSize = 0;
   scope->owner = owner;
   scope->outer = outer;
+  scope->level = (outer != NULL) ? outer->level + 1 : 0;
+  scope->frameSize = RESERVED_WORDS;
+  scope->arena = symArena;
   return scope;
 }
 
 Object* createProgramObject(char *programName) {
-  Object* program = (Object*) malloc(sizeof(Object));
-  strcpy(program->name, programName);
+  Object* program = (Object*) arenaAlloc(symArena, OBJECT_SIZE(progAttrs));
+  setObjectName(program, programName);
   program->kind = OBJ_PROGRAM;
-  program->progAttrs = (ProgramAttributes*) malloc(sizeof(ProgramAttributes));
-  program->progAttrs->scope = createScope(program,NULL);
+  program->progAttrs.scope = createScope(program,NULL);
+  program->progAttrs.body = NULL;
   symtab->program = program;
 
   return program;
 }
 
 Object* createConstantObject(char *name) {
-  Object* obj = (Object*) malloc(sizeof(Object));
-  strcpy(obj->name, name);
+  Object* obj = (Object*) arenaAlloc(symArena, OBJECT_SIZE(constAttrs));
+  setObjectName(obj, name);
   obj->kind = OBJ_CONSTANT;
-  obj->constAttrs = (ConstantAttributes*) malloc(sizeof(ConstantAttributes));
+  obj->constAttrs.value = NULL;
   return obj;
 }
 
 Object* createTypeObject(char *name) {
-  Object* obj = (Object*) malloc(sizeof(Object));
-  strcpy(obj->name, name);
+  Object* obj = (Object*) arenaAlloc(symArena, OBJECT_SIZE(typeAttrs));
+  setObjectName(obj, name);
   obj->kind = OBJ_TYPE;
-  obj->typeAttrs = (TypeAttributes*) malloc(sizeof(TypeAttributes));
+  obj->typeAttrs.actualType = NULL;
   return obj;
 }
 
 Object* createVariableObject(char *name) {
-  Object* obj = (Object*) malloc(sizeof(Object));
-  strcpy(obj->name, name);
+  Object* obj = (Object*) arenaAlloc(symArena, OBJECT_SIZE(varAttrs));
+  setObjectName(obj, name);
   obj->kind = OBJ_VARIABLE;
-  obj->varAttrs = (VariableAttributes*) malloc(sizeof(VariableAttributes));
-  obj->varAttrs->scope = symtab->currentScope;
+  obj->varAttrs.type = NULL;
+  obj->varAttrs.scope = symtab->currentScope;
+  obj->varAttrs.localOffset = 0;
   return obj;
 }
 
 Object* createFunctionObject(char *name) {
-  Object* obj = (Object*) malloc(sizeof(Object));
-  strcpy(obj->name, name);
+  Object* obj = (Object*) arenaAlloc(symArena, OBJECT_SIZE(funcAttrs));
+  setObjectName(obj, name);
   obj->kind = OBJ_FUNCTION;
-  obj->funcAttrs = (FunctionAttributes*) malloc(sizeof(FunctionAttributes));
-  obj->funcAttrs->paramList = NULL;
-  obj->funcAttrs->scope = createScope(obj, symtab->currentScope);
+  obj->funcAttrs.paramList = NULL;
+  obj->funcAttrs.lastParam = NULL;
+  obj->funcAttrs.returnType = NULL;
+  obj->funcAttrs.scope = createScope(obj, symtab->currentScope);
+  obj->funcAttrs.body = NULL;
   return obj;
 }
 
 Object* createProcedureObject(char *name) {
-  Object* obj = (Object*) malloc(sizeof(Object));
-  strcpy(obj->name, name);
+  Object* obj = (Object*) arenaAlloc(symArena, OBJECT_SIZE(procAttrs));
+  setObjectName(obj, name);
   obj->kind = OBJ_PROCEDURE;
-  obj->procAttrs = (ProcedureAttributes*) malloc(sizeof(ProcedureAttributes));
-  obj->procAttrs->paramList = NULL;
-  obj->procAttrs->scope = createScope(obj, symtab->currentScope);
+  obj->procAttrs.paramList = NULL;
+  obj->procAttrs.lastParam = NULL;
+  obj->procAttrs.scope = createScope(obj, symtab->currentScope);
+  obj->procAttrs.body = NULL;
   return obj;
 }
 
 Object* createParameterObject(char *name, enum ParamKind kind, Object* owner) {
-  Object* obj = (Object*) malloc(sizeof(Object));
-  strcpy(obj->name, name);
+  Object* obj = (Object*) arenaAlloc(symArena, OBJECT_SIZE(paramAttrs));
+  setObjectName(obj, name);
   obj->kind = OBJ_PARAMETER;
-  obj->paramAttrs = (ParameterAttributes*) malloc(sizeof(ParameterAttributes));
-  obj->paramAttrs->kind = kind;
-  obj->paramAttrs->function = owner;
+  obj->paramAttrs.kind = kind;
+  obj->paramAttrs.type = NULL;
+  obj->paramAttrs.function = owner;
+  obj->paramAttrs.localOffset = 0;
   return obj;
 }
 
-void freeObject(Object* obj) {
-  switch (obj->kind) {
-  case OBJ_CONSTANT:
-    free(obj->constAttrs->value);
-    free(obj->constAttrs);
-    break;
-  case OBJ_TYPE:
-    free(obj->typeAttrs->actualType);
-    free(obj->typeAttrs);
-    break;
-  case OBJ_VARIABLE:
-    free(obj->varAttrs->type);
-    free(obj->varAttrs);
-    break;
-  case OBJ_FUNCTION:
-    freeReferenceList(obj->funcAttrs->paramList);
-    freeType(obj->funcAttrs->returnType);
-    freeScope(obj->funcAttrs->scope);
-    free(obj->funcAttrs);
-    break;
-  case OBJ_PROCEDURE:
-    freeReferenceList(obj->procAttrs->paramList);
-    freeScope(obj->procAttrs->scope);
-    free(obj->procAttrs);
-    break;
-  case OBJ_PROGRAM:
-    freeScope(obj->progAttrs->scope);
-    free(obj->progAttrs);
-    break;
-  case OBJ_PARAMETER:
-    freeType(obj->paramAttrs->type);
-    free(obj->paramAttrs);
-  }
-  free(obj);
+// Append obj to the list that *last ends, NULL for an empty list
+ObjectNode* addObject(Arena* arena, ObjectNode **objList, ObjectNode **last, Object* obj) {
+  ObjectNode* node = (ObjectNode*) arenaAlloc(arena, sizeof(ObjectNode));
+  node->object = obj;
+  node->next = NULL;
+  if ((*last) == NULL) 
+    *objList = node;
+  else (*last)->next = node;
+  *last = node;
+  return node;
 }
 
-void freeScope(Scope* scope) {
-  freeObjectList(scope->objList);
-  free(scope);
+/******************* Scope tables ******************************/
+
+unsigned hashName(char *name) {
+  return hashString(name, strlen(name));
 }
 
-void freeObjectList(ObjectNode *objList) {
-  ObjectNode* list = objList;
+void insertScopeNode(Scope* scope, ObjectNode* node) {
+  int i = node->hash & (scope->tableSize - 1);
 
-  while (list != NULL) {
-    ObjectNode* node = list;
-    list = list->next;
-    freeObject(node->object);
-    free(node);
-  }
+  while (scope->table[i] != NULL)
+    i = (i + 1) & (scope->tableSize - 1);
+  scope->table[i] = node;
 }
 
-void freeReferenceList(ObjectNode *objList) {
-  ObjectNode* list = objList;
+// The outgrown table stays in the arena, which at most doubles its space
+void growScopeTable(Scope* scope) {
+  ObjectNode* node;
 
-  while (list != NULL) {
-    ObjectNode* node = list;
-    list = list->next;
-    free(node);
-  }
+  scope->tableSize = (scope->tableSize == 0) ? 4 * SCOPE_TABLE_MIN : 2 * scope->tableSize;
+  scope->table = (ObjectNode**) arenaAlloc(scope->arena, scope->tableSize * sizeof(ObjectNode*));
+  memset(scope->table, 0, scope->tableSize * sizeof(ObjectNode*));
+  for (node = scope->objList; node != NULL; node = node->next)
+    insertScopeNode(scope, node);
 }
 
-void addObject(ObjectNode **objList, Object* obj) {
-  ObjectNode* node = (ObjectNode*) malloc(sizeof(ObjectNode));
-  node->object = obj;
-  node->next = NULL;
-  if ((*objList) == NULL) 
-    *objList = node;
-  else {
-    ObjectNode *n = *objList;
-    while (n->next != NULL) 
-      n = n->next;
-    n->next = node;
+ObjectNode* addScopeObject(Scope* scope, Object* obj) {
+  ObjectNode* node = addObject(scope->arena, &(scope->objList), &(scope->lastObject), obj);
+
+  node->index = scope->objectCount++;
+  node->hash = hashName(obj->name);
+  if (2 * scope->objectCount > scope->tableSize) {
+    if (scope->objectCount >= SCOPE_TABLE_MIN)
+      growScopeTable(scope);
+  } else insertScopeNode(scope, node);
+  return node;
+}
+
+ObjectNode* findScopeNode(Scope* scope, char *name, unsigned hash) {
+  ObjectNode* node;
+  int i;
+
+  if (scope->table == NULL) {
+    for (node = scope->objList; node != NULL; node = node->next)
+      if ((node->hash == hash) && (strcmp(node->object->name, name) == 0))
+	return node;
+    return NULL;
   }
+
+  for (i = hash & (scope->tableSize - 1); (node = scope->table[i]) != NULL;
+       i = (i + 1) & (scope->tableSize - 1))
+    if ((node->hash == hash) && (strcmp(node->object->name, name) == 0))
+      return node;
+  return NULL;
+}
+
+Object* findScopeObject(Scope* scope, char *name) {
+  ObjectNode* node = findScopeNode(scope, name, hashName(name));
+
+  return (node != NULL) ? node->object : NULL;
 }
 
 Object* findObject(ObjectNode *objList, char *name) {
@@ -266,69 +361,86 @@ Object* findObject(ObjectNode *objList, char *name) {
 void initSymTab(void) {
   Object* obj;
   Object* param;
+  ObjectNode* lastGlobal = NULL;
 
-  symtab = (SymTab*) malloc(sizeof(SymTab));
+  initArena(&symtabArena);
+  symArena = &symtabArena;
+  symtab = (SymTab*) arenaAlloc(symArena, sizeof(SymTab));
+  symtab->program = NULL;
+  symtab->currentScope = NULL;
   symtab->globalObjectList = NULL;
+  initIdentTable();
   
   obj = createFunctionObject("READC");
-  obj->funcAttrs->returnType = makeCharType();
-  addObject(&(symtab->globalObjectList), obj);
+  obj->funcAttrs.returnType = makeCharType();
+  addObject(symArena, &(symtab->globalObjectList), &lastGlobal, obj);
 
   obj = createFunctionObject("READI");
-  obj->funcAttrs->returnType = makeIntType();
-  addObject(&(symtab->globalObjectList), obj);
+  obj->funcAttrs.returnType = makeIntType();
+  addObject(symArena, &(symtab->globalObjectList), &lastGlobal, obj);
 
   obj = createProcedureObject("WRITEI");
   param = createParameterObject("i", PARAM_VALUE, obj);
-  param->paramAttrs->type = makeIntType();
-  addObject(&(obj->procAttrs->paramList),param);
-  addObject(&(symtab->globalObjectList), obj);
+  param->paramAttrs.type = makeIntType();
+  addObject(symArena, &(obj->procAttrs.paramList), &(obj->procAttrs.lastParam), param);
+  addObject(symArena, &(symtab->globalObjectList), &lastGlobal, obj);
 
   obj = createProcedureObject("WRITEC");
   param = createParameterObject("ch", PARAM_VALUE, obj);
-  param->paramAttrs->type = makeCharType();
-  addObject(&(obj->procAttrs->paramList),param);
-  addObject(&(symtab->globalObjectList), obj);
+  param->paramAttrs.type = makeCharType();
+  addObject(symArena, &(obj->procAttrs.paramList), &(obj->procAttrs.lastParam), param);
+  addObject(symArena, &(symtab->globalObjectList), &lastGlobal, obj);
 
   obj = createProcedureObject("WRITELN");
-  addObject(&(symtab->globalObjectList), obj);
-
-  intType = makeIntType();
-  charType = makeCharType();
+  addObject(symArena, &(symtab->globalObjectList), &lastGlobal, obj);
 }
 
 void cleanSymTab(void) {
-  freeObject(symtab->program);
-  freeObjectList(symtab->globalObjectList);
-  free(symtab);
-  freeType(intType);
-  freeType(charType);
+  freeIdentTable();
+  freeArena(&symtabArena);
+  symtab = NULL;
 }
 
 void enterBlock(Scope* scope) {
   symtab->currentScope = scope;
+  openScope(scope);
 }
 
 void exitBlock(void) {
+  closeScope();
   symtab->currentScope = symtab->currentScope->outer;
 }
 
+// Leave the blocks entered since scope was the current one
+void restoreBlock(Scope* scope) {
+  while (symtab->currentScope != scope)
+    exitBlock();
+}
+
+// Objects of the current scope get the next words of its frame
 void declareObject(Object* obj) {
+  Scope* scope = symtab->currentScope;
+
   if (obj->kind == OBJ_PARAMETER) {
-    Object* owner = symtab->currentScope->owner;
+    Object* owner = scope->owner;
     switch (owner->kind) {
     case OBJ_FUNCTION:
-      addObject(&(owner->funcAttrs->paramList), obj);
+      addObject(owner->funcAttrs.scope->arena, &(owner->funcAttrs.paramList), &(owner->funcAttrs.lastParam), obj);
       break;
     case OBJ_PROCEDURE:
-      addObject(&(owner->procAttrs->paramList), obj);
+      addObject(owner->procAttrs.scope->arena, &(owner->procAttrs.paramList), &(owner->procAttrs.lastParam), obj);
       break;
     default:
       break;
     }
+    obj->paramAttrs.localOffset = scope->frameSize;
+    scope->frameSize ++;
+  } else if (obj->kind == OBJ_VARIABLE) {
+    obj->varAttrs.localOffset = scope->frameSize;
+    scope->frameSize += sizeOfType(obj->varAttrs.type);
   }
  
-  addObject(&(symtab->currentScope->objList), obj);
+  bindObject(addScopeObject(scope, obj));
 }
 
 
@@ -8,6 +8,7 @@
 #define __SYMTAB_H__
 
 #include "token.h"
+#include "arena.h"
 
 enum TypeClass {
   TP_INT,
@@ -25,6 +26,17 @@ enum ObjectKind {
   OBJ_PROGRAM
 };
 
+// A frame begins with RESERVED_WORDS words: a function's result at
+// RETURN_VALUE_OFFSET, the dynamic link, the return address and the
+// static link. The parameters follow in order, one word each (a VAR
+// parameter holds an address), then the variables in order.
+#define RESERVED_WORDS 4
+#define RETURN_VALUE_OFFSET 0
+
+// Words taken by a value of each basic type
+#define INT_SIZE 1
+#define CHAR_SIZE 1
+
 enum ParamKind {
   PARAM_VALUE,
   PARAM_REFERENCE
@@ -53,6 +65,7 @@ typedef struct ConstantValue_ ConstantValue;
 struct Scope_;
 struct ObjectNode_;
 struct Object_;
+struct Node_;
 
 struct ConstantAttributes_ {
   ConstantValue* value;
@@ -61,6 +74,7 @@ struct ConstantAttributes_ {
 struct VariableAttributes_ {
   Type *type;
   struct Scope_ *scope;
+  int localOffset;              // in the frame of scope
 };
 
 struct TypeAttributes_ {
@@ -69,23 +83,29 @@ struct TypeAttributes_ {
 
 struct ProcedureAttributes_ {
   struct ObjectNode_ *paramList;
+  struct ObjectNode_ *lastParam;
   struct Scope_* scope;
+  struct Node_ *body;
 };
 
 struct FunctionAttributes_ {
   struct ObjectNode_ *paramList;
+  struct ObjectNode_ *lastParam;
   Type* returnType;
   struct Scope_ *scope;
+  struct Node_ *body;
 };
 
 struct ProgramAttributes_ {
   struct Scope_ *scope;
+  struct Node_ *body;
 };
 
 struct ParameterAttributes_ {
   enum ParamKind kind;
   Type* type;
   struct Object_ *function;
+  int localOffset;              // in the frame of function's scope
 };
 
 typedef struct ConstantAttributes_ ConstantAttributes;
@@ -97,16 +117,19 @@ typedef struct ProgramAttributes_ ProgramAttributes;
 typedef struct ParameterAttributes_ ParameterAttributes;
 
 struct Object_ {
-  char name[MAX_IDENT_LEN];
+  char *name;                         // points to inlineName or to the string pool
+  char inlineName[MAX_INLINE_LEN + 1];
   enum ObjectKind kind;
+  // The attributes of its kind, held in the object itself. Objects are
+  // allocated only up to the end of their own member: never copy one.
   union {
-    ConstantAttributes* constAttrs;
-    VariableAttributes* varAttrs;
-    TypeAttributes* typeAttrs;
-    FunctionAttributes* funcAttrs;
-    ProcedureAttributes* procAttrs;
-    ProgramAttributes* progAttrs;
-    ParameterAttributes* paramAttrs;
+    ConstantAttributes constAttrs;
+    VariableAttributes varAttrs;
+    TypeAttributes typeAttrs;
+    FunctionAttributes funcAttrs;
+    ProcedureAttributes procAttrs;
+    ProgramAttributes progAttrs;
+    ParameterAttributes paramAttrs;
   };
 };
 
@@ -115,14 +138,28 @@ typedef struct Object_ Object;
 struct ObjectNode_ {
   Object *object;
   struct ObjectNode_ *next;
+  int index;                    // position in its scope, from 0
+  unsigned hash;                // of the object's name
 };
 
 typedef struct ObjectNode_ ObjectNode;
 
+// A scope lists its objects in declaration order. Once it holds
+// SCOPE_TABLE_MIN of them, they are also found by name through an open
+// addressing table of at most half full slots.
+#define SCOPE_TABLE_MIN 8
+
 struct Scope_ {
   ObjectNode *objList;
+  ObjectNode *lastObject;       // the end of objList, where objects are added
+  int objectCount;
+  ObjectNode **table;           // NULL for a free slot
+  int tableSize;                // a power of two, 0 without a table
   Object *owner;
   struct Scope_ *outer;
+  int level;                    // static nesting depth, 0 at the outermost
+  int frameSize;                // words of a frame of its owner
+  Arena *arena;                 // where its nodes and table are allocated
 };
 
 typedef struct Scope_ Scope;
@@ -135,18 +172,30 @@ struct SymTab_ {
 
 typedef struct SymTab_ SymTab;
 
+// While a subprogram body is parsed on its own thread, only the objects
+// of snapshotScope up to snapshotLast are visible to it: those declared
+// before the body in source order
+extern _Thread_local Scope* snapshotScope;
+extern _Thread_local ObjectNode* snapshotLast;
+
+// Objects, scopes and constant values are allocated from *symArena, which
+// is the compilation's own arena unless a subprogram's block is set apart
+// (see parallel.c); cleanSymTab() releases them all at once
+extern _Thread_local Arena* symArena;
+
+void initTypes(void);
+void freeTypes(void);
 Type* makeIntType(void);
 Type* makeCharType(void);
 Type* makeArrayType(int arraySize, Type* elementType);
-Type* duplicateType(Type* type);
-int compareType(Type* type1, Type* type2);
-void freeType(Type* type);
+int sizeOfType(Type* type);
 
 ConstantValue* makeIntConstant(int i);
 ConstantValue* makeCharConstant(char ch);
 ConstantValue* duplicateConstantValue(ConstantValue* v);
 
 Scope* createScope(Object* owner, Scope* outer);
+int objectSize(Object* obj);
 
 Object* createProgramObject(char *programName);
 Object* createConstantObject(char *name);
@@ -157,11 +206,15 @@ Object* createProcedureObject(char *name);
 Object* createParameterObject(char *name, enum ParamKind kind, Object* owner);
 
 Object* findObject(ObjectNode *objList, char *name);
+unsigned hashName(char *name);
+ObjectNode* findScopeNode(Scope* scope, char *name, unsigned hash);
+Object* findScopeObject(Scope* scope, char *name);
 
 void initSymTab(void);
 void cleanSymTab(void);
 void enterBlock(Scope* scope);
 void exitBlock(void);
+void restoreBlock(Scope* scope);
 void declareObject(Object* obj);
 
 #endif
@@ -0,0 +1,171 @@
+#!/bin/sh
+# Timings on large generated programs, run by "make bench" from the
+# directory of kplc. Nothing is checked: compare the times printed before
+# and after a change. The programs are written to tests/*.tmp.
+
+# Print the best of three times of "kplc $2 $1" in milliseconds, or that
+# it failed. Standard input is the file $3, if given.
+bench() {
+  best=
+  for i in 1 2 3; do
+    start=$(date +%s%N)
+    if ! ./kplc $2 $1 < ${3:-/dev/null} > /dev/null 2>&1; then
+      printf "%-28s %-4s failed\n" "${1#tests/}" "$2"
+      return
+    fi
+    end=$(date +%s%N)
+    t=$(( (end - start) / 1000000 ))
+    { [ -z "$best" ] || [ $t -lt $best ]; } && best=$t
+  done
+  printf "%-28s %-4s %6d ms\n" "${1#tests/}" "$2" $best
+}
+
+# Each mode that parses a whole program
+modes() {
+  for o in "" -s -p4 -t -g; do
+    bench $1 "$o"
+  done
+}
+
+# 20000 variables named by $1 and a number, each assigned from the one
+# before it
+names() {
+  awk -v p=$1 'BEGIN {
+    n = 20000
+    print "Program Names;"
+    print "Var " p "1 : Integer;"
+    for (i = 2; i <= n; i++) print "    " p i " : Integer;"
+    print "Begin"
+    print "  " p "1 := 0;"
+    for (i = 2; i < n; i++) print "  " p i " := " p (i - 1) " + 1;"
+    print "  " p n " := " p (n - 1)
+    print "End."
+  }'
+}
+
+# Short names take the inline copy in Object, long ones the interned string
+names V > tests/short.tmp
+names VARIABLEWITHANAMEOFFORTYCHARACTERSINALL > tests/long.tmp
+for f in tests/short.tmp tests/long.tmp; do
+  modes $f
+done
+
+# 10 million comments between blanks. A stack of 256 KB leaves no room
+# for a scanner frame per comment.
+awk 'BEGIN {
+  print "Program Comments;"
+  for (i = 0; i < 10000000; i++) print "  (* comment *)  "
+  print "Begin End."
+}' > tests/comments.tmp
+(ulimit -s 256; modes tests/comments.tmp)
+
+# One expression of 100000 terms with all four operators. Operators are
+# parsed in loops, so this too runs on a 256 KB stack.
+awk 'BEGIN {
+  split(" + | * | - | / ", op, "|")
+  print "Program Expression;"
+  print "Var X : Integer;"
+  print "    A : Array(. 10 .) of Integer;"
+  print "Begin"
+  printf "  X := X"
+  for (i = 1; i < 100000; i++) {
+    printf "%s%s", op[i % 4 + 1], (i % 3) ? "X" : "A(.1.)"
+    if (i % 10 == 0) printf "\n   "
+  }
+  print ""
+  print "End."
+}' > tests/expression.tmp
+(ulimit -s 256; modes tests/expression.tmp)
+
+# 10000 nested IFs around 10000 nested indexes. Only -s parses statements
+# without recursion, so this one gets the usual stack.
+awk 'BEGIN {
+  n = 10000
+  print "Program Nesting;"
+  print "Var X : Integer;"
+  print "    A : Array(. 10 .) of Integer;"
+  print "Begin"
+  for (i = 0; i < n; i++) print "  If X < " i " Then"
+  for (i = 0; i < n; i++) printf "A(."
+  printf "1"
+  for (i = 0; i < n; i++) printf ".)"
+  print " := X"
+  print "End."
+}' > tests/nesting.tmp
+modes tests/nesting.tmp
+
+# 100000 globals, and a procedure whose 20000 locals shadow every fifth
+# of them. Its nested procedure looks up locals, globals and shadowed
+# names alike.
+awk 'BEGIN {
+  n = 100000
+  print "Program Scope;"
+  print "Var G1 : Integer;"
+  for (i = 2; i <= n; i++) print "    G" i " : Integer;"
+  print "Procedure P;"
+  print "Var G5 : Integer;"
+  for (i = 10; i <= n; i += 5) print "    G" i " : Integer;"
+  print "    L : Integer;"
+  print "  Procedure Q;"
+  print "  Begin"
+  for (i = 1; i < n; i += 7) print "    L := G" i " + G" (n - i) ";"
+  print "    L := 0"
+  print "  End;"
+  print "Begin Call Q End;"
+  print "Begin Call P End."
+}' > tests/scope.tmp
+modes tests/scope.tmp
+
+# 3000 subprograms, each with constants, types, parameters and variables
+# of its own and a nested function. -w compiles it 11 times, freeing all
+# of it after each.
+awk 'BEGIN {
+  n = 3000
+  print "Program Subprograms;"
+  print "Var X : Integer;"
+  for (i = 1; i <= n; i++) {
+    print "Procedure P" i "(A : Integer; Var B : Integer; C : Char);"
+    print "Const K = " i "; L = K * 2;"
+    print "Type T = Array(. 10 .) of Integer; U = Array(. 5 .) of T;"
+    print "Var U1 : U; V : T; W : Integer;"
+    print "  Function F(D : Integer) : Integer;"
+    print "  Var E : Integer;"
+    print "  Begin E := D + K; F := E * L End;"
+    print "Begin"
+    print "  W := F(A) + B;"
+    print "  V(.1.) := W;"
+    print "  U1(.2.)(.3.) := V(.1.);"
+    print "  B := U1(.2.)(.3.)"
+    print "End;"
+  }
+  print "Begin"
+  for (i = 1; i <= n; i++) print "  Call P" i "(X, X, \047c\047);"
+  print "  X := 0"
+  print "End."
+}' > tests/subprograms.tmp
+printf '\n\n\n\n\n\n\n\n\n\n' > tests/lines.tmp
+modes tests/subprograms.tmp
+bench tests/subprograms.tmp -w tests/lines.tmp
+
+# Every name looked up is followed by a use of its attributes: 20000
+# constants folded from the one before, 20000 arrays indexed, and 2000
+# functions whose parameters check the arguments of each call
+awk 'BEGIN {
+  n = 20000
+  print "Program Attributes;"
+  print "Const K1 = 1;"
+  for (i = 2; i <= n; i++) print "      K" i " = K" (i - 1) " + 1;"
+  print "Var A1 : Array(. 10 .) of Integer;"
+  for (i = 2; i <= n; i++) print "    A" i " : Array(. 10 .) of Integer;"
+  for (i = 1; i <= n / 10; i++)
+    print "Function F" i "(X : Integer; Var Y : Integer; C : Char) : Integer;" \
+      " Begin F" i " := X + Y End;"
+  print "Begin"
+  for (i = 1; i < n; i++)
+    print "  A" i "(.K" (i % 10 + 1) ".) := F" (i % (n / 10) + 1) "(K" i ", A" (i + 1) "(.1.), \047c\047) + K" (n - i) ";"
+  print "  A1(.1.) := K1"
+  print "End."
+}' > tests/attributes.tmp
+modes tests/attributes.tmp
+
+rm -f tests/*.tmp
@@ -0,0 +1,114 @@
+#!/bin/sh
+# Regression tests, run by "make test" from the directory of kplc
+
+fail=0
+out=tests/out.tmp
+
+# Compare the output in $out with the file $1; $2 names the run
+check() {
+  cmp -s $out $1 || { echo "FAIL: $2"; fail=1; }
+}
+
+# Every tests/exampleN.kpl that has a tests/resultN.txt is compiled with
+# -a in each parsing mode. -g stops at the first error, so it may print
+# only the first line.
+for r in tests/result[0-9]*.txt; do
+  n=${r#tests/result}; f=tests/example${n%.txt}.kpl
+  for o in "" -s -p2 -t; do
+    ./kplc $o -a $f > $out 2>&1
+    check $r "kplc $o -a $f"
+  done
+  ./kplc -w -a $f < /dev/null 2>&1 | sed '$d' > $out
+  check $r "kplc -w -a $f"
+  ./kplc -g -a $f > $out 2>&1
+  cmp -s $out $r || head -n 1 $r | cmp -s $out - || { echo "FAIL: kplc -g -a $f"; fail=1; }
+done
+
+# tests/declsN.txt is the output of -i, which compiles the declarations
+# only, for tests/exampleN.kpl. The statements skipped do not count, so
+# -g prints it whole too.
+for r in tests/decls[0-9]*.txt; do
+  n=${r#tests/decls}; f=tests/example${n%.txt}.kpl
+  for o in "" -s -p2 -t -g; do
+    ./kplc $o -i $f > $out 2>&1
+    check $r "kplc $o -i $f"
+  done
+  ./kplc -w -i $f < /dev/null 2>&1 | sed '$d' > $out
+  check $r "kplc -w -i $f"
+done
+
+# -w sessions on a copy of tests/watch.kpl. Each round edits the copy with
+# a sed script, and the recompilation must print what a fresh compilation
+# of the same text does. The rounds change one body, insert lines above
+# others, break a body and mend it, delete a procedure, declare a global
+# before the others, and go back to the base text.
+session() {
+  cp tests/watch.kpl tests/session.tmp
+  rm -f tests/in.tmp
+  mkfifo tests/in.tmp
+  ./kplc -w -a $1 tests/session.tmp < tests/in.tmp > $out 2>&1 &
+  pid=$!
+  exec 3> tests/in.tmp
+  # If kplc dies, the rounds go on to the failed check
+  trap '' PIPE
+  ./kplc -a tests/session.tmp > tests/expected.tmp 2>&1
+  echo . >> tests/expected.tmp
+  done=1
+  while read -r script; do
+    # Wait for the previous compilation before changing its input
+    while [ "$(grep -c '^\.$' $out)" -lt $done ] && kill -0 $pid 2> /dev/null; do
+      sleep 0.05
+    done
+    if [ "$script" = reset ]; then
+      cp tests/watch.kpl tests/session.tmp
+    else
+      sed -e "$script" tests/session.tmp > tests/edit.tmp
+      mv tests/edit.tmp tests/session.tmp
+    fi
+    ./kplc -a tests/session.tmp >> tests/expected.tmp 2>&1
+    echo . >> tests/expected.tmp
+    echo >&3 2> /dev/null
+    done=$((done + 1))
+  done <<'ROUNDS'
+s/D := X;/D := X + G;/
+s/^Procedure Q;/(* two lines *)\n\nProcedure Q;/
+s/E := 2;/E := 'c';/
+s/E := 'c';/E := 2;/
+/^Procedure R/,/^End;/d;s/Call R('r')/Call Q/
+s/^Var G : Integer;/Var H : Char;\n    G : Integer;/
+reset
+ROUNDS
+  exec 3>&-
+  wait $pid
+  check tests/expected.tmp "kplc -w -a $1 session"
+}
+
+for o in "" -p2 -s; do
+  session "$o"
+done
+
+# A module written with -m prints, once read back with -l, the
+# declarations the compilation printed
+for n in 4 7 14 21; do
+  f=tests/example$n.kpl
+  ./kplc -m tests/module.tmp $f > tests/expected.tmp 2>&1
+  ./kplc -l tests/module.tmp > $out 2>&1
+  check tests/expected.tmp "kplc -m, then -l, $f"
+done
+
+# Damaged modules are refused before they are mapped: a wrong magic
+# number, version or object size, then two truncated files
+./kplc -m tests/module.tmp tests/example7.kpl > /dev/null
+for damage in "0 X" "4 \143" "12 \143"; do
+  cp tests/module.tmp tests/damaged.tmp
+  printf "${damage#* }" | dd of=tests/damaged.tmp bs=1 seek=${damage% *} conv=notrunc 2> /dev/null
+  ./kplc -l tests/damaged.tmp
+done > $out 2>&1
+for size in 100 10; do
+  head -c $size tests/module.tmp > tests/damaged.tmp
+  ./kplc -l tests/damaged.tmp
+done >> $out 2>&1
+check tests/modules.txt "kplc -l on damaged modules"
+
+rm -f tests/*.tmp
+[ $fail = 0 ] && echo "All tests passed."
@@ -9,7 +9,7 @@
 #include "token.h"
 
 struct {
-  char string[MAX_IDENT_LEN + 1];
+  char string[MAX_INLINE_LEN + 1];
   TokenType tokenType;
 } keywords[KEYWORDS_COUNT] = {
   {"PROGRAM", KW_PROGRAM},
@@ -55,6 +55,8 @@ Token* makeToken(TokenType tokenType, int lineNo, int colNo) {
   token->tokenType = tokenType;
   token->lineNo = lineNo;
   token->colNo = colNo;
+  token->buf[0] = '\0';
+  token->string = token->buf;
   return token;
 }
 
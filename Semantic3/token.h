@@ -7,7 +7,9 @@
 #ifndef __TOKEN_H__
 #define __TOKEN_H__
 
-#define MAX_IDENT_LEN 15
+// Lexemes up to MAX_INLINE_LEN characters are stored inside the token;
+// longer ones are interned in the string pool.
+#define MAX_INLINE_LEN 15
 #define KEYWORDS_COUNT 20
 
 typedef enum {
@@ -27,7 +29,8 @@ typedef enum {
 } TokenType; 
 
 typedef struct {
-  char string[MAX_IDENT_LEN + 1];
+  char *string;
+  char buf[MAX_INLINE_LEN + 1];
   int lineNo, colNo;
   TokenType tokenType;
   int value;
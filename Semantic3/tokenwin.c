@@ -0,0 +1,294 @@
+/* 
+ * @copyright (c) 2026
+ * @author agent <agent@local>
+ * @version 1.0
+ */
+
+#include <stdlib.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include "scanner.h"
+#include "error.h"
+#include "tokenwin.h"
+
+// Ring buffer of scanned but not yet consumed tokens.
+// windowSize is always a power of two.
+Token** window = NULL;
+int windowSize = 0;
+int windowHead = 0;
+int windowCount = 0;
+
+int threadedScan = 0;
+
+/******************* Scanner thread ******************************/
+
+// Single-producer/single-consumer queue between the scanner thread and the
+// window. Only the scanner writes queueTail and only the parser writes
+// queueHead; each side publishes its index with a release store.
+#define QUEUE_SIZE 4096
+
+Token* queue[QUEUE_SIZE];
+atomic_uint queueHead;
+atomic_uint queueTail;
+atomic_int producerDone;
+atomic_int stopProducer;
+pthread_t producer;
+int producerActive = 0;
+
+int isLastOfBatch(Token* token) {
+  return (token->tokenType == TK_EOF) || (token->tokenType == TK_NONE);
+}
+
+// The scanner thread stops after the end of file or the first lexical
+// error; whatever follows is scanned on demand by the parser thread.
+void* produceTokens(void* arg) {
+  int done = 0;
+
+  while (!done && !atomic_load_explicit(&stopProducer, memory_order_relaxed)) {
+    unsigned tail = atomic_load_explicit(&queueTail, memory_order_relaxed);
+    unsigned head = atomic_load_explicit(&queueHead, memory_order_acquire);
+    unsigned space = QUEUE_SIZE - (tail - head);
+    unsigned n;
+
+    if (space == 0) {
+      sched_yield();
+      continue;
+    }
+    if (space > TOKEN_BATCH) space = TOKEN_BATCH;
+
+    for (n = 0; (n < space) && !done; n++) {
+      Token* token = getToken();
+      queue[(tail + n) & (QUEUE_SIZE - 1)] = token;
+      done = isLastOfBatch(token);
+    }
+    atomic_store_explicit(&queueTail, tail + n, memory_order_release);
+  }
+
+  atomic_store_explicit(&producerDone, 1, memory_order_release);
+  return NULL;
+}
+
+// Move the next batch from the queue into the window. Returns 0 once the
+// scanner thread has finished and the queue is empty.
+int popTokenBatch(void) {
+  unsigned head = atomic_load_explicit(&queueHead, memory_order_relaxed);
+  unsigned tail;
+  unsigned n;
+
+  for (;;) {
+    tail = atomic_load_explicit(&queueTail, memory_order_acquire);
+    if (tail != head) break;
+    if (atomic_load_explicit(&producerDone, memory_order_acquire)) {
+      tail = atomic_load_explicit(&queueTail, memory_order_acquire);
+      if (tail == head) return 0;
+      break;
+    }
+    sched_yield();
+  }
+
+  for (n = 0; (n < tail - head) && (n < TOKEN_BATCH); ) {
+    Token* token = queue[(head + n) & (QUEUE_SIZE - 1)];
+    window[(windowHead + windowCount) & (windowSize - 1)] = token;
+    windowCount ++;
+    n ++;
+    if (isLastOfBatch(token)) break;
+  }
+  atomic_store_explicit(&queueHead, head + n, memory_order_release);
+  return 1;
+}
+
+void startProducer(void) {
+  atomic_store(&queueHead, 0);
+  atomic_store(&queueTail, 0);
+  atomic_store(&producerDone, 0);
+  atomic_store(&stopProducer, 0);
+  producerActive = (pthread_create(&producer, NULL, produceTokens, NULL) == 0);
+}
+
+// Join the scanner thread. With discard set, tokens still queued are freed.
+void stopScannerThread(int discard) {
+  if (!producerActive) return;
+
+  if (discard) {
+    atomic_store(&stopProducer, 1);
+    pthread_join(producer, NULL);
+    while (atomic_load(&queueHead) != atomic_load(&queueTail)) {
+      free(queue[atomic_load(&queueHead) & (QUEUE_SIZE - 1)]);
+      atomic_fetch_add(&queueHead, 1);
+    }
+  } else pthread_join(producer, NULL);
+  producerActive = 0;
+}
+
+/******************* Token array ******************************/
+
+// When the whole input is scanned in advance, every thread reads it at
+// its own position and the window is not used
+Token** tokenArray = NULL;
+int tokenCount = 0;
+_Thread_local int tokenPos = 0;
+
+void freeTokenArray(void) {
+  int i;
+
+  for (i = 0; i < tokenCount; i++)
+    free(tokenArray[i]);
+  free(tokenArray);
+  tokenArray = NULL;
+  tokenCount = 0;
+}
+
+// Scan the whole input into tokenArray, ending with its TK_EOF token.
+// Returns 0 and keeps nothing if the input has lexical errors, whose
+// diagnostics the window reports in order with the parser's.
+int loadTokenArray(void) {
+  Token* token;
+  int size = 1024;
+  int valid = 1;
+
+  tokenArray = (Token**) malloc(size * sizeof(Token*));
+  tokenCount = 0;
+  do {
+    token = getToken();
+    if (tokenCount == size) {
+      size *= 2;
+      tokenArray = (Token**) realloc(tokenArray, size * sizeof(Token*));
+    }
+    tokenArray[tokenCount++] = token;
+    if (token->tokenType == TK_NONE) valid = 0;
+  } while (token->tokenType != TK_EOF);
+
+  tokenPos = 0;
+  if (!valid) freeTokenArray();
+  return valid;
+}
+
+Token* tokenAt(int index) {
+  return tokenArray[(index < tokenCount) ? index : tokenCount - 1];
+}
+
+int tokenIndex(void) {
+  return tokenPos;
+}
+
+void seekToken(int index) {
+  tokenPos = index;
+}
+
+// A private copy of the next array token, which the parser frees as it
+// does window tokens
+Token* copyArrayToken(void) {
+  Token* source = tokenAt(tokenPos);
+  Token* token = (Token*) malloc(sizeof(Token));
+
+  *token = *source;
+  if (source->string == source->buf)
+    token->string = token->buf;
+  if (tokenPos < tokenCount) tokenPos ++;
+  return token;
+}
+
+/******************* Token window ******************************/
+
+void growTokenWindow(void) {
+  int newSize = windowSize * 2;
+  Token** newWindow = (Token**) malloc(newSize * sizeof(Token*));
+  int i;
+
+  for (i = 0; i < windowCount; i++)
+    newWindow[i] = window[(windowHead + i) & (windowSize - 1)];
+  free(window);
+  window = newWindow;
+  windowSize = newSize;
+  windowHead = 0;
+}
+
+// Scan up to TOKEN_BATCH more tokens. A batch ends early at the end of
+// file or at a lexical error, which stops the scanner from running far
+// past a point the parser may never reach.
+void fillTokenWindow(void) {
+  Token* token;
+  int i;
+
+  while (windowSize - windowCount < TOKEN_BATCH)
+    growTokenWindow();
+
+  if (producerActive) {
+    if (popTokenBatch()) return;
+    // The scanner thread is done; scan the rest on this thread
+    stopScannerThread(0);
+  }
+
+  for (i = 0; i < TOKEN_BATCH; i++) {
+    token = getToken();
+    window[(windowHead + windowCount) & (windowSize - 1)] = token;
+    windowCount ++;
+    if (isLastOfBatch(token)) break;
+  }
+}
+
+// Make sure at least k + 1 valid tokens are buffered. Invalid tokens are
+// reported and dropped once they come into view, like getValidToken() does.
+// A batch stops at an invalid token, so it can only be the last one.
+void ensureTokens(int k) {
+  Token* token;
+
+  for (;;) {
+    if (windowCount > 0) {
+      token = window[(windowHead + windowCount - 1) & (windowSize - 1)];
+      if ((token->tokenType == TK_NONE) && (windowCount - 1 <= k)) {
+        reportError(token->value, token->lineNo, token->colNo);
+        windowCount --;
+        free(token);
+        continue;
+      }
+    }
+    if (windowCount > k) return;
+    fillTokenWindow();
+  }
+}
+
+void initTokenWindow(void) {
+  windowSize = 2 * TOKEN_BATCH;
+  window = (Token**) malloc(windowSize * sizeof(Token*));
+  windowHead = 0;
+  windowCount = 0;
+  if (threadedScan) startProducer();
+}
+
+void freeTokenWindow(void) {
+  if (tokenArray != NULL) {
+    freeTokenArray();
+    return;
+  }
+  stopScannerThread(1);
+  discardPendingToken();
+  while (windowCount > 0) {
+    free(window[windowHead]);
+    windowHead = (windowHead + 1) & (windowSize - 1);
+    windowCount --;
+  }
+  free(window);
+  window = NULL;
+  windowSize = 0;
+}
+
+// Return the k-th upcoming token without consuming it (k = 0 is the next one)
+Token* peekToken(int k) {
+  if (tokenArray != NULL) return tokenAt(tokenPos + k);
+  ensureTokens(k);
+  return window[(windowHead + k) & (windowSize - 1)];
+}
+
+// Remove the next token from the window; the caller owns it afterwards
+Token* nextToken(void) {
+  Token* token;
+
+  if (tokenArray != NULL) return copyArrayToken();
+  ensureTokens(0);
+  token = window[windowHead];
+  windowHead = (windowHead + 1) & (windowSize - 1);
+  windowCount --;
+  return token;
+}
@@ -0,0 +1,30 @@
+/* 
+ * @copyright (c) 2026
+ * @author agent <agent@local>
+ * @version 1.0
+ */
+
+#ifndef __TOKENWIN_H__
+#define __TOKENWIN_H__
+
+#include "token.h"
+
+// Number of tokens the scanner produces per refill of the window
+#define TOKEN_BATCH 256
+
+// When set before initTokenWindow(), the scanner runs on its own thread
+// and hands tokens over in batches through a lock-free queue
+extern int threadedScan;
+
+void initTokenWindow(void);
+int loadTokenArray(void);
+void freeTokenWindow(void);
+Token* peekToken(int k);
+Token* nextToken(void);
+
+// Positions in the token array, for threads parsing parts of it
+int tokenIndex(void);
+void seekToken(int index);
+Token* tokenAt(int index);
+
+#endif
@@ -0,0 +1,117 @@
+/*
+ * @copyright (c) 2026
+ * @author agent <agent@local>
+ * @version 1.0
+ */
+
+#include "trace.h"
+
+#ifdef PARSE_TRACE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <stdatomic.h>
+
+struct TraceEvent {
+  long long time;               // nanoseconds
+  const char* rule;             // NULL for an exit
+  int thread;
+};
+
+int traceEnabled = 0;
+_Thread_local int traceDepth = 0;
+
+struct TraceEvent* traceBuffer = NULL;
+atomic_llong traceCount;
+atomic_int traceThreads;
+_Thread_local int traceThread = -1;
+
+void traceEvent(const char* rule) {
+  struct TraceEvent* event;
+  struct timespec now;
+
+  if (traceThread < 0)
+    traceThread = atomic_fetch_add(&traceThreads, 1);
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  event = &traceBuffer[atomic_fetch_add(&traceCount, 1) & (TRACE_BUFFER_SIZE - 1)];
+  event->time = now.tv_sec * 1000000000LL + now.tv_nsec;
+  event->rule = rule;
+  event->thread = traceThread;
+}
+
+char* traceFile = NULL;
+
+void startTrace(char* fileName) {
+  traceBuffer = (struct TraceEvent*) malloc(TRACE_BUFFER_SIZE * sizeof(struct TraceEvent));
+  traceFile = fileName;
+  traceEnabled = 1;
+  // A fatal error ends compilation with exit()
+  atexit(dumpTrace);
+}
+
+void traceEnter(const char* rule) {
+  if (!traceEnabled) return;
+  traceDepth ++;
+  traceEvent(rule);
+}
+
+void traceExit(const char** rule) {
+  if (!traceEnabled) return;
+  traceDepth --;
+  traceEvent(NULL);
+}
+
+void traceUnwind(int depth) {
+  while (traceEnabled && (traceDepth > depth)) {
+    traceDepth --;
+    traceEvent(NULL);
+  }
+}
+
+// Write the buffered events as Chrome trace events, one B/E pair per rule
+// invocation. Exits whose entry has been overwritten are left out; the
+// rules a fatal error left open keep only their B.
+void dumpTrace(void) {
+  FILE* f;
+  long long count, first;
+  int* open;
+  struct TraceEvent* event;
+  long long i;
+  int comma = 0;
+
+  if (!traceEnabled) return;
+  traceEnabled = 0;
+  f = fopen(traceFile, "w");
+  if (f == NULL) {
+    printf("parser: can\'t write trace file %s\n", traceFile);
+    return;
+  }
+
+  count = atomic_load(&traceCount);
+  first = (count > TRACE_BUFFER_SIZE) ? count - TRACE_BUFFER_SIZE : 0;
+  open = (int*) calloc(atomic_load(&traceThreads) + 1, sizeof(int));
+
+  fprintf(f, "{\"traceEvents\":[\n");
+  for (i = first; i < count; i++) {
+    event = &traceBuffer[i & (TRACE_BUFFER_SIZE - 1)];
+    if (event->rule == NULL) {
+      if (open[event->thread] == 0) continue;
+      open[event->thread] --;
+    } else open[event->thread] ++;
+    fprintf(f, "%s{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":1,\"tid\":%d}",
+	    comma ? ",\n" : "", event->rule == NULL ? "" : event->rule,
+	    event->rule == NULL ? 'E' : 'B',
+	    (event->time - traceBuffer[first & (TRACE_BUFFER_SIZE - 1)].time) / 1000.0,
+	    event->thread);
+    comma = 1;
+  }
+  fprintf(f, "\n],\"displayTimeUnit\":\"ns\"}\n");
+  fclose(f);
+  free(open);
+  free(traceBuffer);
+  traceBuffer = NULL;
+}
+
+#endif
@@ -0,0 +1,48 @@
+/*
+ * @copyright (c) 2026
+ * @author agent <agent@local>
+ * @version 1.0
+ */
+
+#ifndef __TRACE_H__
+#define __TRACE_H__
+
+// Trace of grammar rule entries and exits, built in with -DPARSE_TRACE
+// (make TRACE=1) and switched on at run time. Events go to a ring buffer
+// holding the last TRACE_BUFFER_SIZE of them, which dumpTrace() writes in
+// the Chrome trace-event format (chrome://tracing, ui.perfetto.dev).
+// Without PARSE_TRACE the macros below expand to nothing.
+
+#define TRACE_BUFFER_SIZE (1 << 20)
+
+#ifdef PARSE_TRACE
+
+extern int traceEnabled;
+extern _Thread_local int traceDepth;
+
+void startTrace(char* fileName);
+void traceEnter(const char* rule);
+void traceExit(const char** rule);
+void traceUnwind(int depth);
+void dumpTrace(void);
+
+// First statement of a rule: records its entry, and its exit whenever the
+// function returns
+#define TRACE_RULE() \
+  const char* traceRule __attribute__((cleanup(traceExit))) = __func__; \
+  traceEnter(traceRule)
+
+// Rules left by an error recovery jump record no exit. The place the jump
+// lands saves the depth beforehand and closes those rules there.
+#define TRACE_MARK(mark) int mark = traceDepth
+#define TRACE_UNWIND(mark) traceUnwind(mark)
+
+#else
+
+#define TRACE_RULE() ((void) 0)
+#define TRACE_MARK(mark) ((void) 0)
+#define TRACE_UNWIND(mark) ((void) 0)
+
+#endif
+
+#endif